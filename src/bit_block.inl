@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+/** \brief Bit manipulation kernels for 8x8 bitmask blocks, \sa QuadNode::Block.
+ *
+ * Pixel (x, y) of a block is bit (y * 8 + x), so each byte holds one row, with the top row in the
+ * least significant byte and the leftmost pixel in the least significant bit of each row.
+ *
+ * Each kernel is a constant number of shifts and masks, rather than a loop over 64 pixels. See
+ * the <a href="https://www.chessprogramming.org/Flipping_Mirroring_and_Rotating">
+ *      Chess Programming Wiki
+ * </a> for derivations. */
+
+/** \brief Mirrors a block top to bottom, ie. row y becomes row 7 - y. */
+inline uint64_t flip_block_vertical(uint64_t block)
+{
+    constexpr uint64_t k1 = 0x00FF00FF00FF00FFull;
+    constexpr uint64_t k2 = 0x0000FFFF0000FFFFull;
+
+    block = ((block >>  8) & k1) | ((block & k1) <<  8);
+    block = ((block >> 16) & k2) | ((block & k2) << 16);
+    block = ( block >> 32)       | ( block       << 32);
+    return block;
+}
+
+/** \brief Mirrors a block left to right, ie. column x becomes column 7 - x. */
+inline uint64_t flip_block_horizontal(uint64_t block)
+{
+    constexpr uint64_t k1 = 0x5555555555555555ull;
+    constexpr uint64_t k2 = 0x3333333333333333ull;
+    constexpr uint64_t k4 = 0x0F0F0F0F0F0F0F0Full;
+
+    block = ((block >> 1) & k1) | ((block & k1) << 1);
+    block = ((block >> 2) & k2) | ((block & k2) << 2);
+    block = ((block >> 4) & k4) | ((block & k4) << 4);
+    return block;
+}
+
+/** \brief Transposes a block, ie. pixel (x, y) becomes pixel (y, x). */
+inline uint64_t transpose_block(uint64_t block)
+{
+    constexpr uint64_t k1 = 0x5500550055005500ull;
+    constexpr uint64_t k2 = 0x3333000033330000ull;
+    constexpr uint64_t k4 = 0x0F0F0F0F00000000ull;
+
+    uint64_t t;
+    t     = k4 & (block ^ (block << 28));
+    block ^=       t    ^ (t     >> 28);
+    t     = k2 & (block ^ (block << 14));
+    block ^=       t    ^ (t     >> 14);
+    t     = k1 & (block ^ (block <<  7));
+    block ^=       t    ^ (t     >>  7);
+    return block;
+}
+
+/** \brief Rotates a block a quarter turn clockwise. */
+inline uint64_t rotate_block_clockwise90(uint64_t block)
+{
+    return flip_block_horizontal(transpose_block(block));
+}
+
+/** \brief Rotates a block a half turn. */
+inline uint64_t rotate_block_clockwise180(uint64_t block)
+{
+    return flip_block_vertical(flip_block_horizontal(block));
+}
+
+/** \brief Rotates a block three quarter turns clockwise. */
+inline uint64_t rotate_block_clockwise270(uint64_t block)
+{
+    return flip_block_vertical(transpose_block(block));
+}
@@ -3,18 +3,20 @@
 #include <iostream>
 #include <cstdlib>
 
-inline void usage(std::string name, std::string reason)
+inline void usage(std::string name, std::string reason,
+                  std::string arguments = "{image_file} [output_file.bmp|output_file.pbm]")
 {
     std::string usage("usage:");
-    usage += "\n\t" + name + " {image_file}";
+    usage += "\n\t" + name + " " + arguments;
 
     std::cout
         << reason << std::endl
         << usage << std::endl;
 }
 
-inline void fail(std::string name, std::string reason)
+inline void fail(std::string name, std::string reason,
+                 std::string arguments = "{image_file} [output_file.bmp|output_file.pbm]")
 {
-    usage(name, reason);
+    usage(name, reason, arguments);
     exit(-1);
 }
@@ -0,0 +1,177 @@
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "cli_utils.inl"
+#include "tree_server.hpp"
+
+namespace {
+
+const std::string ARGUMENTS = "[--socket {socket_path}] [--capacity {trees}]";
+
+/** \brief The longest command line accepted from a client, in bytes. */
+constexpr size_t MAX_COMMAND_LENGTH = 1 << 16;
+
+/** \brief The resident trees and the server executing commands on them. */
+struct Service {
+    TreeCache cache;
+    TreeServer server;
+
+    explicit Service(size_t capacity) :
+        cache(capacity),
+        server(cache)
+    { }
+};
+
+/** \brief Executes the commands a client sends, until it quits, disconnects or misbehaves. */
+void serve_commands(TreeServer& server, int client)
+{
+    std::string pending;
+    char buffer[4096];
+
+    for (;;) {
+        auto received = read(client, buffer, sizeof(buffer));
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            break;
+        }
+        pending.append(buffer, received);
+
+        // execute every complete line, keep any partial line for the next read
+        size_t line_end;
+        bool quit = false;
+        while (!quit && (line_end = pending.find('\n')) != std::string::npos) {
+            auto command = pending.substr(0, line_end);
+            pending.erase(0, line_end + 1);
+            if (command.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;
+            }
+
+            auto response = server.execute(command) + "\n";
+            for (size_t sent = 0; sent < response.size();) {
+                // a client hanging up must not raise SIGPIPE and take down the daemon
+                auto written = send(client, response.data() + sent, response.size() - sent,
+                                    MSG_NOSIGNAL);
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (written <= 0) {
+                    quit = true;
+                    break;
+                }
+                sent += written;
+            }
+
+            quit = quit || TreeServer::is_quit(command);
+        }
+
+        if (quit) {
+            break;
+        }
+
+        // no command is this long, the client isn't speaking the protocol
+        if (pending.size() > MAX_COMMAND_LENGTH) {
+            break;
+        }
+    }
+}
+
+/** \brief Serves one client connected to the socket, until it quits or disconnects.
+ *
+ * \param service Shared with the other clients, so it outlives whichever of them ends last.
+ * \param client The client's socket, closed once the client is served. */
+void serve_client(std::shared_ptr<Service> service, int client)
+{
+    // commands answer their own failures, anything else only ends this client's connection
+    try {
+        serve_commands(service->server, client);
+    } catch (const std::exception&) { }
+
+    close(client);
+}
+
+/** \brief Accepts clients on a Unix domain socket, serving each on its own thread.
+ *
+ * Client threads are detached, and each holds a reference to the service, so it stays alive
+ * until the last client is done even if this returns. */
+int serve_socket(const std::string& progName, std::shared_ptr<Service> service,
+                 const std::string& path)
+{
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        fail(progName, std::string("unable to create socket: ") + strerror(errno), ARGUMENTS);
+    }
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        fail(progName, "socket path too long: " + path, ARGUMENTS);
+    }
+    std::strcpy(address.sun_path, path.c_str());
+
+    unlink(path.c_str());
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, SOMAXCONN) != 0) {
+        fail(progName, "unable to listen on " + path + ": " + strerror(errno), ARGUMENTS);
+    }
+
+    for (;;) {
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        try {
+            std::thread(serve_client, service, client).detach();
+        } catch (const std::system_error&) {
+            // out of threads, turn this client away rather than every client
+            close(client);
+        }
+    }
+
+    close(listener);
+    return -1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    std::string progName = argv[0];
+    std::string socket_path;
+    size_t capacity = TreeCache::DEFAULT_CAPACITY;
+
+    for (int arg = 1; arg < argc; ++arg) {
+        std::string option = argv[arg];
+        if (option == "--socket" && arg + 1 < argc) {
+            socket_path = argv[++arg];
+        } else if (option == "--capacity" && arg + 1 < argc) {
+            capacity = std::strtoul(argv[++arg], nullptr, 10);
+        } else {
+            fail(progName, "unknown option: " + option, ARGUMENTS);
+        }
+    }
+
+    // trees stay resident between commands, and between clients
+    auto service = std::make_shared<Service>(capacity);
+
+    if (socket_path.empty()) {
+        service->server.serve(std::cin, std::cout);
+        return 0;
+    }
+
+    return serve_socket(progName, service, socket_path);
+}
@@ -0,0 +1,256 @@
+#include "distance_transform.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace {
+
+/** \brief Squared distance standing in for infinity, large enough that sums don't overflow. */
+constexpr uint64_t INFINITE = std::numeric_limits<uint64_t>::max() / 4;
+
+} // namespace
+
+bool
+DistanceTransform::find_nearest_black(const QuadTree& tree, Point from, Point& nearest)
+{
+    auto side_length = tree.get_side_length();
+    if (side_length == 0 || from.x >= side_length || from.y >= side_length) {
+        return false;
+    }
+
+    auto root = tree.get_root();
+    std::priority_queue<Candidate> candidates;
+    candidates.push({ 0, root.get(), 0, 0 });
+
+    while (!candidates.empty()) {
+        auto candidate = candidates.top();
+        candidates.pop();
+
+        // every remaining candidate is at least as far, so the first pixel popped is nearest
+        if (!candidate.node) {
+            nearest = { candidate.x, candidate.y };
+            return true;
+        }
+
+        const auto& node = *candidate.node;
+        if (node.get_black_pixels() == 0) {
+            continue;
+        }
+
+        auto node_side_length = node.get_side_length();
+        if (node.is_block()) {
+            for (size_t y = 0; y < node_side_length; ++y) {
+                for (size_t x = 0; x < node_side_length; ++x) {
+                    if ((node.get_block() >> (y * node_side_length + x)) & 1) {
+                        Point pixel = { candidate.x + x, candidate.y + y };
+                        auto distance = get_squared_distance(from, pixel.x, pixel.y, 1);
+                        candidates.push({ distance, nullptr, pixel.x, pixel.y });
+                    }
+                }
+            }
+            continue;
+        }
+
+        if (node.is_leaf()) {
+            // the nearest pixel of a black leaf is the query point clamped to its quadrant
+            auto x = std::min(std::max(from.x, candidate.x), candidate.x + node_side_length - 1);
+            auto y = std::min(std::max(from.y, candidate.y), candidate.y + node_side_length - 1);
+            candidates.push({ candidate.squared_distance, nullptr, x, y });
+            continue;
+        }
+
+        auto half = node_side_length / 2;
+        const auto& children = node.get_children();
+        const QuadNode* quadrants[] = {
+            children.q1.get(), children.q2.get(), children.q3.get(), children.q4.get()
+        };
+        size_t x_offsets[] = { candidate.x + half, candidate.x, candidate.x, candidate.x + half };
+        size_t y_offsets[] = { candidate.y, candidate.y, candidate.y + half, candidate.y + half };
+
+        for (size_t ndx = 0; ndx < 4; ++ndx) {
+            if (quadrants[ndx]->get_black_pixels() != 0) {
+                auto distance = get_squared_distance(from, x_offsets[ndx], y_offsets[ndx], half);
+                candidates.push({ distance, quadrants[ndx], x_offsets[ndx], y_offsets[ndx] });
+            }
+        }
+    }
+
+    return false;
+}
+
+double
+DistanceTransform::get_distance(const QuadTree& tree, Point from)
+{
+    Point nearest;
+    if (!find_nearest_black(tree, from, nearest)) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    auto dx = double(nearest.x) - double(from.x);
+    auto dy = double(nearest.y) - double(from.y);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+std::vector<double>
+DistanceTransform::compute_distance_map(const QuadTree& tree)
+{
+    auto side_length = tree.get_side_length();
+    if (side_length == 0) {
+        return { };
+    }
+
+    std::vector<std::vector<Interval>> columns(side_length);
+    collect_columns(*tree.get_root(), 0, 0, columns);
+
+    // first pass, squared distance to the nearest black pixel within each column
+    std::vector<uint64_t> squared(side_length * side_length, INFINITE);
+    for (size_t x = 0; x < side_length; ++x) {
+        auto& intervals = columns[x];
+        if (intervals.empty()) {
+            continue;
+        }
+
+        std::sort(intervals.begin(), intervals.end(), [](const Interval& one, const Interval& other) {
+            return one.begin < other.begin;
+        });
+
+        size_t next = 0;
+        for (size_t y = 0; y < side_length; ++y) {
+            while (next < intervals.size() && intervals[next].end <= y) {
+                ++next;
+            }
+
+            uint64_t distance = INFINITE;
+            if (next < intervals.size()) {
+                distance = intervals[next].begin > y ? intervals[next].begin - y : 0;
+            }
+            if (next > 0) {
+                distance = std::min<uint64_t>(distance, y + 1 - intervals[next - 1].end);
+            }
+
+            squared[y * side_length + x] = distance == INFINITE ? INFINITE : distance * distance;
+        }
+    }
+
+    // second pass, the lower envelope of the parabolas rooted at each column of each row
+    std::vector<double> distances(side_length * side_length,
+                                  std::numeric_limits<double>::infinity());
+    std::vector<size_t> roots(side_length);
+    std::vector<double> bounds(side_length + 1);
+
+    for (size_t y = 0; y < side_length; ++y) {
+        auto row = squared.begin() + y * side_length;
+        auto height = [&](size_t x) { return double(row[x]) + double(x) * double(x); };
+
+        size_t parabolas = 0;
+        for (size_t x = 0; x < side_length; ++x) {
+            if (row[x] == INFINITE) {
+                continue;
+            }
+
+            double intersection = -std::numeric_limits<double>::infinity();
+            while (parabolas > 0) {
+                auto root = roots[parabolas - 1];
+                intersection = (height(x) - height(root)) / (2.0 * x - 2.0 * root);
+                if (intersection > bounds[parabolas - 1]) {
+                    break;
+                }
+                --parabolas;
+                intersection = -std::numeric_limits<double>::infinity();
+            }
+
+            roots[parabolas] = x;
+            bounds[parabolas] = intersection;
+            ++parabolas;
+        }
+
+        if (parabolas == 0) {
+            continue;
+        }
+
+        bounds[parabolas] = std::numeric_limits<double>::infinity();
+        size_t parabola = 0;
+        for (size_t x = 0; x < side_length; ++x) {
+            while (bounds[parabola + 1] < x) {
+                ++parabola;
+            }
+
+            auto root = roots[parabola];
+            auto dx = double(x) - double(root);
+            distances[y * side_length + x] = std::sqrt(dx * dx + double(row[root]));
+        }
+    }
+
+    return distances;
+}
+
+bool
+DistanceTransform::Candidate::operator<(const Candidate& other) const
+{
+    if (squared_distance != other.squared_distance) {
+        return squared_distance > other.squared_distance;
+    }
+
+    return !node && other.node;
+}
+
+uint64_t
+DistanceTransform::get_squared_distance(Point from, size_t x, size_t y, size_t side_length)
+{
+    auto gap = [&](size_t from, size_t begin) -> uint64_t {
+        if (from < begin) {
+            return begin - from;
+        }
+        return from >= begin + side_length ? from - (begin + side_length - 1) : 0;
+    };
+
+    auto dx = gap(from.x, x);
+    auto dy = gap(from.y, y);
+    return dx * dx + dy * dy;
+}
+
+void
+DistanceTransform::collect_columns(const QuadNode& node, size_t x_off, size_t y_off,
+                                   std::vector<std::vector<Interval>>& columns)
+{
+    if (node.get_black_pixels() == 0) {
+        return;
+    }
+
+    auto side_length = node.get_side_length();
+    if (node.is_block()) {
+        for (size_t x = 0; x < side_length; ++x) {
+            for (size_t y = 0; y < side_length; ++y) {
+                if (!((node.get_block() >> (y * side_length + x)) & 1)) {
+                    continue;
+                }
+
+                // extend the column's last interval while the run continues
+                auto& intervals = columns[x_off + x];
+                if (!intervals.empty() && intervals.back().end == y_off + y) {
+                    ++intervals.back().end;
+                } else {
+                    intervals.push_back({ y_off + y, y_off + y + 1 });
+                }
+            }
+        }
+        return;
+    }
+
+    if (node.is_leaf()) {
+        for (auto x = x_off; x < x_off + side_length; ++x) {
+            columns[x].push_back({ y_off, y_off + side_length });
+        }
+        return;
+    }
+
+    auto half = side_length / 2;
+    const auto& children = node.get_children();
+
+    collect_columns(*children.q2, x_off       , y_off       , columns);
+    collect_columns(*children.q1, x_off + half, y_off       , columns);
+    collect_columns(*children.q3, x_off       , y_off + half, columns);
+    collect_columns(*children.q4, x_off + half, y_off + half, columns);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "quad_tree.hpp"
+
+/** \brief Distances from the pixels of a QuadTree's image to their nearest black pixels.
+ *
+ * Distances are Euclidean, between pixel centers.
+ *
+ * Nearest black pixel queries are a best-first search over the tree's nodes, ordered by the
+ * distance to each node's quadrant. Subtrees without black pixels are pruned by their cached
+ * black pixel count, \sa QuadNode::get_black_pixels(), and a black leaf answers for all of its
+ * pixels at once, so a query visits the nodes near the query point rather than the whole tree.
+ *
+ * Distance maps are computed by the exact, separable transform of Felzenszwalb and Huttenlocher.
+ * Its first pass is seeded with the black intervals of each column, taken from the tree's leaves
+ * without expanding them into pixels, so its cost is linear in the number of pixels rather than
+ * the product of the number of pixels and black pixels of a brute force transform.
+ *
+ * Distances are not assigned per leaf. That is exact only for black leaves, which are all 0, and
+ * for white quadrants lying within the Voronoi cell of a single black pixel. Along a stroke those
+ * cells are one pixel wide strips, so on drawings almost every white leaf would be split down to
+ * single pixels, each costing a nearest black query. The map has a distance per pixel either
+ * way, and the transform's second pass costs a few operations per pixel, so it runs over the
+ * whole raster. */
+class DistanceTransform
+{
+public:
+    /** \brief A pixel of an image. */
+    struct Point {
+        size_t x; ///< The pixel's column, counted from the left
+        size_t y; ///< The pixel's row, counted from the top
+    };
+
+    /** \brief Finds the black pixel nearest to a pixel.
+     *
+     * \param tree The tree encoding the image.
+     * \param from The pixel to search from.
+     * \param nearest Set to the nearest black pixel, if any. Ties are broken arbitrarily.
+     * \return true iff the tree is valid, from lies within the image and the image has a black
+     *         pixel. */
+    static bool find_nearest_black(const QuadTree& tree, Point from, Point& nearest);
+
+    /** \brief Query the distance from a pixel to its nearest black pixel.
+     *
+     * \param tree The tree encoding the image.
+     * \param from The pixel to measure from.
+     * \return The distance, or infinity if there is no black pixel, or the query is invalid, \sa
+     *         find_nearest_black(). */
+    static double get_distance(const QuadTree& tree, Point from);
+
+    /** \brief Computes the distance from every pixel to its nearest black pixel.
+     *
+     * Linear in the number of pixels, \sa DistanceTransform for why distances aren't assigned
+     * per leaf.
+     *
+     * \param tree The tree encoding the image.
+     * \return The distances, in the pixel order of QuadTree::decode(), which are infinity if the
+     *         image has no black pixel, or no distances if the tree is invalid. */
+    static std::vector<double> compute_distance_map(const QuadTree& tree);
+
+private:
+    /** \brief A run of rows [begin, end) of one column. */
+    struct Interval {
+        size_t begin; ///< The first row of the run
+        size_t end;   ///< One past the last row of the run
+    };
+
+    /** \brief An entry of the best-first search, \sa find_nearest_black().
+     *
+     * Either a node whose quadrant lies at least squared_distance away, or a black pixel exactly
+     * squared_distance away, if node is null. */
+    struct Candidate {
+        uint64_t squared_distance; ///< Lower bound on the squared distance to any pixel within
+        const QuadNode* node;      ///< The node, or null for a single pixel
+        size_t x;                  ///< Column of the quadrant's left edge, or of the pixel
+        size_t y;                  ///< Row of the quadrant's top edge, or of the pixel
+
+        /** \brief Orders candidates farthest first, and pixels after nodes at equal distances,
+         *  for use in a max heap. */
+        bool operator<(const Candidate& other) const;
+    };
+
+    /** \brief Query the squared distance from a pixel to the nearest pixel of a square.
+     *
+     * \param from The pixel.
+     * \param x Column of the square's left edge.
+     * \param y Row of the square's top edge.
+     * \param side_length The side length of the square.
+     * \return The squared distance, 0 if the pixel lies within the square. */
+    static uint64_t get_squared_distance(Point from, size_t x, size_t y, size_t side_length);
+
+    /** \brief Collects the black intervals of each column of a subtree.
+     *
+     * \param node The root of the subtree.
+     * \param x_off x offset of the subtree's quadrant within the image
+     * \param y_off y offset of the subtree's quadrant within the image
+     * \param columns The black intervals of each column of the image, appended to. */
+    static void collect_columns(const QuadNode& node, size_t x_off, size_t y_off,
+                                std::vector<std::vector<Interval>>& columns);
+};
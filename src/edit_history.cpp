@@ -0,0 +1,63 @@
+#include "edit_history.hpp"
+
+EditHistory::EditHistory() = default;
+
+void
+EditHistory::init(const QuadTree& tree)
+{
+    undo_.clear();
+    redo_.clear();
+    current_ = tree;
+}
+
+const QuadTree&
+EditHistory::get_current() const
+{
+    return current_;
+}
+
+void
+EditHistory::push(const QuadTree& tree)
+{
+    undo_.push_back(current_);
+    redo_.clear();
+    current_ = tree;
+}
+
+bool
+EditHistory::can_undo() const
+{
+    return !undo_.empty();
+}
+
+bool
+EditHistory::can_redo() const
+{
+    return !redo_.empty();
+}
+
+bool
+EditHistory::undo()
+{
+    if (!can_undo()) {
+        return false;
+    }
+
+    redo_.push_back(current_);
+    current_ = undo_.back();
+    undo_.pop_back();
+    return true;
+}
+
+bool
+EditHistory::redo()
+{
+    if (!can_redo()) {
+        return false;
+    }
+
+    undo_.push_back(current_);
+    current_ = redo_.back();
+    redo_.pop_back();
+    return true;
+}
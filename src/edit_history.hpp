@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "quad_tree.hpp"
+
+/** \brief Undo/redo history of the versions of an edited image.
+ *
+ * Each version is a QuadTree snapshot. Since QuadTrees are persistent, consecutive versions share
+ * every subtree an edit did not touch, so the memory held by the history grows with the size of
+ * the edits made, not with the size of the image times the number of versions, \sa QuadTree.
+ *
+ * The history is lazily initialized with its first version via init(). */
+class EditHistory
+{
+public:
+    /** \brief Constructs an empty history, whose current version is an invalid tree. */
+    EditHistory();
+
+    /** \brief Initializes this history, discarding all previous versions.
+     *
+     * \param tree The initial version of the image. */
+    void init(const QuadTree& tree);
+
+    /** \brief Retrieve the current version of the image.
+     *
+     * \return The current version, or an invalid tree if this history is uninitialized. */
+    const QuadTree& get_current() const;
+
+    /** \brief Records a new version of the image, and makes it current.
+     *
+     * Versions which were undone can no longer be redone after a new one is recorded.
+     *
+     * \param tree The new version of the image. */
+    void push(const QuadTree& tree);
+
+    /** \brief Query whether there is a previous version to go back to. */
+    bool can_undo() const;
+
+    /** \brief Query whether there is an undone version to go forward to. */
+    bool can_redo() const;
+
+    /** \brief Makes the previous version current.
+     *
+     * \return true iff there was a previous version, \sa can_undo(). */
+    bool undo();
+
+    /** \brief Makes the most recently undone version current.
+     *
+     * \return true iff there was an undone version, \sa can_redo(). */
+    bool redo();
+
+private:
+    std::vector<QuadTree> undo_; ///< Previous versions, the most recent last
+    std::vector<QuadTree> redo_; ///< Undone versions, the most recently undone last
+    QuadTree current_;           ///< The current version
+};
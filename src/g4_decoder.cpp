@@ -0,0 +1,306 @@
+#include "g4_decoder.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+// Modified Huffman run length codes, from ITU-T T.4, as bit strings
+
+/** \brief White run lengths 0 to 63, by length. */
+const char* const WHITE_TERMINATING[] = {
+    "00110101", "000111", "0111", "1000", "1011", "1100",
+    "1110", "1111", "10011", "10100", "00111", "01000",
+    "001000", "000011", "110100", "110101", "101010", "101011",
+    "0100111", "0001100", "0001000", "0010111", "0000011", "0000100",
+    "0101000", "0101011", "0010011", "0100100", "0011000", "00000010",
+    "00000011", "00011010", "00011011", "00010010", "00010011", "00010100",
+    "00010101", "00010110", "00010111", "00101000", "00101001", "00101010",
+    "00101011", "00101100", "00101101", "00000100", "00000101", "00001010",
+    "00001011", "01010010", "01010011", "01010100", "01010101", "00100100",
+    "00100101", "01011000", "01011001", "01011010", "01011011", "01001010",
+    "01001011", "00110010", "00110011", "00110100"
+};
+
+/** \brief White run lengths 64 to 1728, in steps of 64. */
+const char* const WHITE_MAKE_UP[] = {
+    "11011", "10010", "010111", "0110111", "00110110", "00110111",
+    "01100100", "01100101", "01101000", "01100111", "011001100", "011001101",
+    "011010010", "011010011", "011010100", "011010101", "011010110", "011010111",
+    "011011000", "011011001", "011011010", "011011011", "010011000", "010011001",
+    "010011010", "011000", "010011011"
+};
+
+/** \brief Black run lengths 0 to 63, by length. */
+const char* const BLACK_TERMINATING[] = {
+    "0000110111", "010", "11", "10", "011", "0011",
+    "0010", "00011", "000101", "000100", "0000100", "0000101",
+    "0000111", "00000100", "00000111", "000011000", "0000010111", "0000011000",
+    "0000001000", "00001100111", "00001101000", "00001101100", "00000110111", "00000101000",
+    "00000010111", "00000011000", "000011001010", "000011001011", "000011001100", "000011001101",
+    "000001101000", "000001101001", "000001101010", "000001101011", "000011010010", "000011010011",
+    "000011010100", "000011010101", "000011010110", "000011010111", "000001101100", "000001101101",
+    "000011011010", "000011011011", "000001010100", "000001010101", "000001010110", "000001010111",
+    "000001100100", "000001100101", "000001010010", "000001010011", "000000100100", "000000110111",
+    "000000111000", "000000100111", "000000101000", "000001011000", "000001011001", "000000101011",
+    "000000101100", "000001011010", "000001100110", "000001100111"
+};
+
+/** \brief Black run lengths 64 to 1728, in steps of 64. */
+const char* const BLACK_MAKE_UP[] = {
+    "0000001111", "000011001000", "000011001001", "000001011011", "000000110011", "000000110100",
+    "000000110101", "0000001101100", "0000001101101", "0000001001010", "0000001001011", "0000001001100",
+    "0000001001101", "0000001110010", "0000001110011", "0000001110100", "0000001110101", "0000001110110",
+    "0000001110111", "0000001010010", "0000001010011", "0000001010100", "0000001010101", "0000001011010",
+    "0000001011011", "0000001100100", "0000001100101"
+};
+
+/** \brief Run lengths 1792 to 2560 of either color, in steps of 64. */
+const char* const EXTENDED_MAKE_UP[] = {
+    "00000001000", "00000001100", "00000001101", "000000010010", "000000010011", "000000010100",
+    "000000010101", "000000010110", "000000010111", "000000011100", "000000011101", "000000011110",
+    "000000011111"
+};
+
+/** \brief Maps the codes of one color to their run lengths, keyed by (length << 16) | bits. */
+using CodeTable = std::unordered_map<uint32_t, size_t>;
+
+CodeTable make_code_table(const char* const* terminating, const char* const* make_up)
+{
+    CodeTable table;
+    auto add = [&](const char* code, size_t run) {
+        uint32_t bits = 0;
+        uint32_t length = 0;
+        for (; code[length] != '\0'; ++length) {
+            bits = (bits << 1) | uint32_t(code[length] == '1');
+        }
+        table[(length << 16) | bits] = run;
+    };
+
+    for (size_t ndx = 0; ndx < 64; ++ndx) {
+        add(terminating[ndx], ndx);
+    }
+    for (size_t ndx = 0; ndx < 27; ++ndx) {
+        add(make_up[ndx], 64 * (ndx + 1));
+    }
+    for (size_t ndx = 0; ndx < 13; ++ndx) {
+        add(EXTENDED_MAKE_UP[ndx], 1792 + 64 * ndx);
+    }
+
+    return table;
+}
+
+/** \brief The length of the longest run length code. */
+constexpr uint32_t MAX_CODE_LENGTH = 13;
+
+} // namespace
+
+bool
+G4Decoder::decode(const std::vector<uint8_t>& data, size_t width, size_t height,
+                  std::vector<QuadTree::Runs>& rows)
+{
+    rows.clear();
+    rows.reserve(height);
+
+    // the line above the first is imaginary and white
+    Bits bits { data, 0 };
+    QuadTree::Runs reference;
+
+    for (size_t row = 0; row < height; ++row) {
+        QuadTree::Runs coding;
+
+        // a0 starts on an imaginary white pixel left of the line
+        bool is_black = false;
+        bool is_started = false;
+        size_t a0 = 0;
+
+        while (!is_started || a0 < width) {
+            Mode mode;
+            int offset = 0;
+            if (!read_mode(bits, mode, offset)) {
+                return false;
+            }
+
+            // b1 is the first change of the reference line right of a0, to the opposite color,
+            // changes at even indices turn black
+            auto b1 = std::lower_bound(reference.begin(), reference.end(), is_started ? a0 + 1 : 0);
+            if (b1 != reference.end() && ((b1 - reference.begin()) % 2 == 0) == is_black) {
+                ++b1;
+            }
+            auto b1_column = b1 != reference.end() ? *b1 : width;
+            auto b2_column = b1 != reference.end() && b1 + 1 != reference.end() ? *(b1 + 1) : width;
+
+            switch (mode) {
+            case Mode::Pass:
+                a0 = b2_column;
+                break;
+
+            case Mode::Horizontal: {
+                size_t first_run;
+                size_t second_run;
+                if (!read_run(bits, is_black, first_run) || !read_run(bits, !is_black, second_run)) {
+                    return false;
+                }
+
+                auto a1 = a0 + first_run;
+                auto a2 = a1 + second_run;
+                if (a2 > width) {
+                    return false;
+                }
+
+                add_change(coding, a1, width);
+                add_change(coding, a2, width);
+                a0 = a2;
+                break;
+            }
+
+            case Mode::Vertical: {
+                auto a1 = int64_t(b1_column) + offset;
+                if (a1 < int64_t(a0) || a1 > int64_t(width)) {
+                    return false;
+                }
+
+                a0 = size_t(a1);
+                add_change(coding, a0, width);
+                is_black = !is_black;
+                break;
+            }
+
+            case Mode::EndOfBlock:
+                return false;
+            }
+
+            is_started = true;
+        }
+
+        reference = coding;
+        rows.push_back(std::move(coding));
+    }
+
+    return true;
+}
+
+bool
+G4Decoder::read(const std::vector<uint8_t>& data, size_t width, size_t height, QuadTree& tree)
+{
+    std::vector<QuadTree::Runs> rows;
+    if (width == 0 || height == 0 || !decode(data, width, height, rows)) {
+        return false;
+    }
+
+    size_t side_length = 1;
+    while (side_length < width || side_length < height) {
+        side_length *= 2;
+    }
+
+    tree.init(rows, side_length);
+    return tree.is_valid();
+}
+
+bool
+G4Decoder::read_bit(Bits& bits, bool& bit)
+{
+    if (bits.position >= bits.data.size() * 8) {
+        return false;
+    }
+
+    bit = (bits.data[bits.position / 8] >> (7 - bits.position % 8)) & 1;
+    ++bits.position;
+    return true;
+}
+
+bool
+G4Decoder::read_mode(Bits& bits, Mode& mode, int& offset)
+{
+    // every mode code is a run of zeros, a one, and at most one more bit
+    size_t zeros = 0;
+    bool bit;
+    for (;;) {
+        if (!read_bit(bits, bit)) {
+            return false;
+        }
+        if (bit) {
+            break;
+        }
+        if (++zeros > 11) {
+            return false;
+        }
+    }
+
+    switch (zeros) {
+    case 0: // 1
+        mode = Mode::Vertical;
+        offset = 0;
+        return true;
+
+    case 2: // 001
+        mode = Mode::Horizontal;
+        return true;
+
+    case 3: // 0001
+        mode = Mode::Pass;
+        return true;
+
+    case 1: // 01x
+    case 4: // 00001x
+    case 5: // 000001x
+        if (!read_bit(bits, bit)) {
+            return false;
+        }
+        mode = Mode::Vertical;
+        offset = int(zeros == 1 ? 1 : zeros - 2);
+        offset = bit ? offset : -offset;
+        return true;
+
+    case 11: // 000000000001, the first half of an end of facsimile block
+        mode = Mode::EndOfBlock;
+        return true;
+
+    default: // extensions and invalid codes
+        return false;
+    }
+}
+
+bool
+G4Decoder::read_run(Bits& bits, bool is_black, size_t& run)
+{
+    static const CodeTable white_codes = make_code_table(WHITE_TERMINATING, WHITE_MAKE_UP);
+    static const CodeTable black_codes = make_code_table(BLACK_TERMINATING, BLACK_MAKE_UP);
+    const auto& codes = is_black ? black_codes : white_codes;
+
+    // make-up codes add multiples of 64 until a terminating code ends the run
+    run = 0;
+    for (;;) {
+        uint32_t code = 0;
+        uint32_t length = 0;
+        CodeTable::const_iterator match = codes.end();
+        while (match == codes.end()) {
+            bool bit;
+            if (length == MAX_CODE_LENGTH || !read_bit(bits, bit)) {
+                return false;
+            }
+            code = (code << 1) | uint32_t(bit);
+            match = codes.find((++length << 16) | code);
+        }
+
+        run += match->second;
+        if (match->second < 64) {
+            return true;
+        }
+    }
+}
+
+void
+G4Decoder::add_change(QuadTree::Runs& runs, size_t change, size_t width)
+{
+    // a change at the end of the line has nothing left to color
+    if (change >= width) {
+        return;
+    }
+
+    if (!runs.empty() && runs.back() == change) {
+        runs.pop_back();
+    } else {
+        runs.push_back(change);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "quad_tree.hpp"
+
+/** \brief Decodes CCITT Group 4 (T.6) compressed bilevel images into run-length scanlines.
+ *
+ * Group 4 codes each scanline as the positions of its color changes relative to the previous
+ * line, which is exactly the form of QuadTree::Runs, so images are decoded straight into runs and
+ * built into a tree without ever being expanded into pixels, \sa QuadTree::init(const
+ * std::vector<QuadTree::Runs>&, size_t). Decoding costs time proportional to the number of codes.
+ *
+ * Data is read most significant bit first, as stored in TIFF files with the default FillOrder,
+ * and 0 bits are white, as with the default PhotometricInterpretation of Group 4 TIFF strips.
+ * Uncompressed mode extensions are not supported. */
+class G4Decoder
+{
+public:
+    /** \brief Decodes an image into its run-length encoded scanlines.
+     *
+     * \param data The compressed image, which may be followed by an end of facsimile block.
+     * \param width The image's width.
+     * \param height The image's height.
+     * \param rows Set to the scanlines of the image, from the top.
+     * \return true iff height scanlines were decoded successfully. */
+    static bool decode(const std::vector<uint8_t>& data, size_t width, size_t height,
+                       std::vector<QuadTree::Runs>& rows);
+
+    /** \brief Decodes an image into a QuadTree.
+     *
+     * Like ImageReader, images which are not square with a power of two side are padded with
+     * white on the right and bottom.
+     *
+     * \param data The compressed image.
+     * \param width The image's width.
+     * \param height The image's height.
+     * \param tree Initialized with the image, if it was decoded successfully.
+     * \return true iff the image was decoded successfully. */
+    static bool read(const std::vector<uint8_t>& data, size_t width, size_t height,
+                     QuadTree& tree);
+
+private:
+    /** \brief The coding modes of a two dimensional scanline, \sa read_mode(). */
+    enum class Mode {
+        Pass,
+        Horizontal,
+        Vertical,
+        EndOfBlock
+    };
+
+    /** \brief A cursor over compressed data. */
+    struct Bits {
+        const std::vector<uint8_t>& data; ///< The compressed data
+        size_t position;                  ///< The index of the next bit to read
+    };
+
+    /** \brief Reads the next bit.
+     *
+     * \param bits The cursor to advance.
+     * \param bit Set to the bit read.
+     * \return false if the data is exhausted. */
+    static bool read_bit(Bits& bits, bool& bit);
+
+    /** \brief Reads the next mode code.
+     *
+     * \param bits The cursor to advance.
+     * \param mode Set to the mode read.
+     * \param offset Set to the offset of a1 from b1 for Vertical mode.
+     * \return false if the data is exhausted or holds an unsupported code. */
+    static bool read_mode(Bits& bits, Mode& mode, int& offset);
+
+    /** \brief Reads the make-up and terminating codes of a run.
+     *
+     * \param bits The cursor to advance.
+     * \param is_black Whether to read black or white codes.
+     * \param run Set to the length of the run.
+     * \return false if the data is exhausted or holds an invalid code. */
+    static bool read_run(Bits& bits, bool is_black, size_t& run);
+
+    /** \brief Appends a change to a scanline, cancelling out a change at the same column.
+     *
+     * \param runs The scanline.
+     * \param change The column at which the color changes, ignored if it is past the line.
+     * \param width The width of the scanline. */
+    static void add_change(QuadTree::Runs& runs, size_t change, size_t width);
+};
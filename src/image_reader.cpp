@@ -0,0 +1,192 @@
+#include "image_reader.hpp"
+
+#include <cctype>
+#include <fstream>
+#include <limits>
+
+using ColorValue = QuadNode::ColorValue;
+
+constexpr size_t ImageReader::MAX_SIDE_LENGTH;
+
+bool
+ImageReader::read(std::istream& in, QuadTree& tree)
+{
+    char magic[2];
+    if (!in.read(magic, 2)) {
+        return false;
+    }
+
+    if (magic[0] == 'B' && magic[1] == 'M') {
+        return read_bmp(in, tree);
+    }
+
+    if (magic[0] == 'P' && magic[1] == '4') {
+        return read_pbm(in, tree);
+    }
+
+    return false;
+}
+
+bool
+ImageReader::read(const std::string& file_name, QuadTree& tree)
+{
+    std::ifstream file(file_name, std::ios::in | std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    return read(file, tree);
+}
+
+bool
+ImageReader::read_bmp(std::istream& in, QuadTree& tree)
+{
+    // the signature was consumed, read the rest of the file and info headers
+    constexpr size_t HEADERS_SIZE = 54;
+    uint8_t header[HEADERS_SIZE] = { };
+    if (!in.read(reinterpret_cast<char*>(header) + 2, HEADERS_SIZE - 2)) {
+        return false;
+    }
+
+    auto le = [&](size_t offset, size_t bytes) {
+        uint32_t value = 0;
+        for (size_t ndx = 0; ndx < bytes; ++ndx) {
+            value |= uint32_t(header[offset + ndx]) << (8 * ndx);
+        }
+        return value;
+    };
+
+    uint32_t pixel_offset = le(10, 4);
+    uint32_t info_size = le(14, 4);
+    int32_t width = int32_t(le(18, 4));
+    int32_t height = int32_t(le(22, 4));
+    uint32_t bits_per_pixel = le(28, 2);
+    uint32_t compression = le(30, 4);
+
+    if (info_size < 40 || bits_per_pixel != 1 || compression != 0 || width <= 0 || height == 0) {
+        return false;
+    }
+
+    // a negative height means scanlines are stored top to bottom
+    bool is_bottom_up = height > 0;
+    size_t rows = is_bottom_up ? height : -int64_t(height);
+    if (size_t(width) > MAX_SIDE_LENGTH || rows > MAX_SIDE_LENGTH) {
+        return false;
+    }
+
+    // the palette follows the info header, as BGRX, index 1 is black if it is the darker color
+    uint8_t palette[8];
+    in.seekg(14 + info_size, std::ios::beg);
+    if (!in.read(reinterpret_cast<char*>(palette), sizeof(palette))) {
+        return false;
+    }
+    auto luminance = [&](size_t entry) {
+        return palette[entry * 4] + palette[entry * 4 + 1] + palette[entry * 4 + 2];
+    };
+    bool black_bit = luminance(1) < luminance(0);
+
+    auto side_length = padded_side_length(width, rows);
+    size_t stride = (size_t(width) + 31) / 32 * 4;
+
+    QuadTree::Data data(side_length * side_length, ColorValue::White);
+    std::vector<uint8_t> scanline(stride);
+
+    in.seekg(pixel_offset, std::ios::beg);
+    for (size_t ndx = 0; ndx < rows; ++ndx) {
+        if (!in.read(reinterpret_cast<char*>(scanline.data()), stride)) {
+            return false;
+        }
+
+        auto row = is_bottom_up ? rows - 1 - ndx : ndx;
+        unpack_scanline(scanline, width, black_bit, row, side_length, data);
+    }
+
+    tree.init(data);
+    return tree.is_valid();
+}
+
+bool
+ImageReader::read_pbm(std::istream& in, QuadTree& tree)
+{
+    size_t width;
+    size_t height;
+    if (!read_pbm_number(in, width) || !read_pbm_number(in, height) || width == 0 || height == 0 ||
+        width > MAX_SIDE_LENGTH || height > MAX_SIDE_LENGTH) {
+        return false;
+    }
+
+    // a single whitespace character separates the header from the pixels
+    if (!std::isspace(in.get())) {
+        return false;
+    }
+
+    auto side_length = padded_side_length(width, height);
+    QuadTree::Data data(side_length * side_length, ColorValue::White);
+    std::vector<uint8_t> scanline((width + 7) / 8);
+
+    for (size_t row = 0; row < height; ++row) {
+        if (!in.read(reinterpret_cast<char*>(scanline.data()), scanline.size())) {
+            return false;
+        }
+
+        unpack_scanline(scanline, width, true, row, side_length, data);
+    }
+
+    tree.init(data);
+    return tree.is_valid();
+}
+
+bool
+ImageReader::read_pbm_number(std::istream& in, size_t& value)
+{
+    int next = in.get();
+    while (std::isspace(next) || next == '#') {
+        if (next == '#') {
+            while (next != '\n' && next != std::char_traits<char>::eof()) {
+                next = in.get();
+            }
+        }
+        next = in.get();
+    }
+
+    if (!std::isdigit(next)) {
+        return false;
+    }
+
+    value = 0;
+    while (std::isdigit(next)) {
+        // a number which would overflow can't be a valid dimension anyway
+        if (value > (std::numeric_limits<size_t>::max() - 9) / 10) {
+            return false;
+        }
+        value = value * 10 + (next - '0');
+        next = in.get();
+    }
+
+    in.unget();
+    return true;
+}
+
+void
+ImageReader::unpack_scanline(const std::vector<uint8_t>& scanline, size_t width, bool black_bit,
+                             size_t row, size_t side_length, QuadTree::Data& data)
+{
+    auto pixel = data.begin() + row * side_length;
+    for (size_t x = 0; x < width; ++x, ++pixel) {
+        bool bit = (scanline[x / 8] >> (7 - x % 8)) & 1;
+        if (bit == black_bit) {
+            *pixel = ColorValue::Black;
+        }
+    }
+}
+
+size_t
+ImageReader::padded_side_length(size_t width, size_t height)
+{
+    size_t side_length = 1;
+    while (side_length < width || side_length < height) {
+        side_length *= 2;
+    }
+
+    return side_length;
+}
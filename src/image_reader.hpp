@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "quad_tree.hpp"
+
+/** \brief Reads a 1 bit per pixel image file into a QuadTree.
+ *
+ * Supported formats are those written by ImageWriter: uncompressed, 1 bit per pixel BMP (either
+ * scanline order, with any two color palette), and binary PBM (P4). The format is detected from
+ * the file's contents.
+ *
+ * QuadTrees encode square images with power of two sides, so images of any other size are padded
+ * with white on the right and bottom, \sa QuadTree::scale().
+ *
+ * Images wider or taller than MAX_SIDE_LENGTH are rejected from their header, before any pixels
+ * are allocated, so a malformed file can't exhaust memory. */
+class ImageReader
+{
+public:
+    /** \brief The largest width and height of an image which will be read. */
+    static constexpr size_t MAX_SIDE_LENGTH = 1 << 14;
+
+    /** \brief Reads an image from a stream.
+     *
+     * \param in The stream to read from, which should be opened in binary mode.
+     * \param tree Initialized with the image, if it was read successfully.
+     * \return true iff the image was read successfully. */
+    static bool read(std::istream& in, QuadTree& tree);
+
+    /** \brief Reads an image from a file.
+     *
+     * \param file_name The path of the file to read.
+     * \param tree Initialized with the image, if it was read successfully.
+     * \return true iff the file was opened and its image read successfully. */
+    static bool read(const std::string& file_name, QuadTree& tree);
+
+private:
+    /** \brief Reads the remainder of a BMP file, after its "BM" signature.
+     *
+     * \return true iff the image was read successfully. */
+    static bool read_bmp(std::istream& in, QuadTree& tree);
+
+    /** \brief Reads the remainder of a PBM file, after its "P4" magic number.
+     *
+     * \return true iff the image was read successfully. */
+    static bool read_pbm(std::istream& in, QuadTree& tree);
+
+    /** \brief Reads the next whitespace-delimited number of a PBM header, skipping comments.
+     *
+     * \param in The stream to read from.
+     * \param value Set to the number read.
+     * \return true iff a number was read. */
+    static bool read_pbm_number(std::istream& in, size_t& value);
+
+    /** \brief Unpacks one scanline into a row of a padded, square image.
+     *
+     * \param scanline The packed pixels, most significant bit first.
+     * \param width The number of pixels in the scanline.
+     * \param black_bit The value of the bits which encode black pixels.
+     * \param row The row of the image to write.
+     * \param side_length The side length of the image.
+     * \param data The image to write into, which must be initialized to white. */
+    static void unpack_scanline(const std::vector<uint8_t>& scanline, size_t width, bool black_bit,
+                                size_t row, size_t side_length, QuadTree::Data& data);
+
+    /** \brief Finds the smallest power of two side length which fits an image.
+     *
+     * \param width The image's width.
+     * \param height The image's height.
+     * \return The side length of the padded image. */
+    static size_t padded_side_length(size_t width, size_t height);
+};
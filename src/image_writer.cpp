@@ -0,0 +1,154 @@
+#include "image_writer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+
+constexpr size_t ImageWriter::DEFAULT_BAND_HEIGHT;
+constexpr size_t ImageWriter::BUFFER_SIZE;
+
+ImageWriter::ImageWriter(Format format, size_t band_height) :
+    format_(format),
+    band_height_(std::max<size_t>(1, band_height))
+{ }
+
+bool
+ImageWriter::format_from_file_name(const std::string& file_name, Format& format)
+{
+    auto has_extension = [&](const std::string& extension) {
+        return file_name.size() > extension.size() &&
+            file_name.compare(file_name.size() - extension.size(), extension.size(), extension) == 0;
+    };
+
+    if (has_extension(".bmp")) {
+        format = Format::Bmp;
+        return true;
+    }
+
+    if (has_extension(".pbm")) {
+        format = Format::Pbm;
+        return true;
+    }
+
+    return false;
+}
+
+bool
+ImageWriter::write(const QuadTree& tree, std::ostream& out) const
+{
+    auto side_length = tree.get_side_length();
+    if (side_length == 0) {
+        return false;
+    }
+
+    // BMP scanlines are padded to a multiple of 4 bytes, PBM scanlines to a whole byte
+    auto stride = (format_ == Format::Bmp) ? (side_length + 31) / 32 * 4 : (side_length + 7) / 8;
+
+    std::vector<char> buffer = make_header(side_length, stride);
+    buffer.reserve(BUFFER_SIZE + band_height_ * stride);
+
+    std::vector<uint8_t> band;
+    auto band_count = (side_length + band_height_ - 1) / band_height_;
+    for (size_t band_ndx = 0; band_ndx < band_count; ++band_ndx) {
+        // BMP stores the bottom band first, and each band's scanlines bottom to top
+        auto ndx = (format_ == Format::Bmp) ? band_count - 1 - band_ndx : band_ndx;
+        auto first_row = ndx * band_height_;
+        auto row_count = std::min(band_height_, side_length - first_row);
+
+        if (!tree.pack_rows(first_row, row_count, stride, band)) {
+            return false;
+        }
+
+        if (format_ == Format::Bmp) {
+            for (auto row = row_count; row-- > 0;) {
+                auto scanline = band.begin() + row * stride;
+                buffer.insert(buffer.end(), scanline, scanline + stride);
+            }
+        } else {
+            buffer.insert(buffer.end(), band.begin(), band.end());
+        }
+
+        flush(buffer, out, false);
+        if (!out) {
+            return false;
+        }
+    }
+
+    flush(buffer, out, true);
+    return bool(out);
+}
+
+bool
+ImageWriter::write(const QuadTree& tree, const std::string& file_name) const
+{
+    std::ofstream file(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    return write(tree, file) && bool(file.flush());
+}
+
+std::vector<char>
+ImageWriter::make_header(size_t side_length, size_t stride) const
+{
+    std::vector<char> header;
+
+    if (format_ == Format::Pbm) {
+        auto size = std::to_string(side_length);
+        auto text = "P4\n" + size + " " + size + "\n";
+        header.assign(text.begin(), text.end());
+        return header;
+    }
+
+    constexpr uint32_t FILE_HEADER_SIZE = 14;
+    constexpr uint32_t INFO_HEADER_SIZE = 40;
+    constexpr uint32_t PALETTE_SIZE = 2 * 4;
+    constexpr uint32_t PIXELS_PER_METER = 2835; // 72 DPI
+
+    uint32_t pixel_offset = FILE_HEADER_SIZE + INFO_HEADER_SIZE + PALETTE_SIZE;
+    uint32_t image_size = stride * side_length;
+
+    // file header
+    header.push_back('B');
+    header.push_back('M');
+    put_le(header, pixel_offset + image_size, 4);
+    put_le(header, 0, 4);                    // reserved
+    put_le(header, pixel_offset, 4);
+
+    // info header, a positive height means scanlines are stored bottom to top
+    put_le(header, INFO_HEADER_SIZE, 4);
+    put_le(header, side_length, 4);          // width
+    put_le(header, side_length, 4);          // height
+    put_le(header, 1, 2);                    // planes
+    put_le(header, 1, 2);                    // bits per pixel
+    put_le(header, 0, 4);                    // no compression
+    put_le(header, image_size, 4);
+    put_le(header, PIXELS_PER_METER, 4);
+    put_le(header, PIXELS_PER_METER, 4);
+    put_le(header, 2, 4);                    // palette entries
+    put_le(header, 0, 4);                    // all entries are important
+
+    // palette, as BGRX, index 0 is white and index 1 black, matching the packed scanlines
+    put_le(header, 0x00FFFFFF, 4);
+    put_le(header, 0x00000000, 4);
+
+    return header;
+}
+
+void
+ImageWriter::put_le(std::vector<char>& buffer, uint32_t value, size_t bytes)
+{
+    for (size_t ndx = 0; ndx < bytes; ++ndx) {
+        buffer.push_back(char((value >> (8 * ndx)) & 0xFF));
+    }
+}
+
+void
+ImageWriter::flush(std::vector<char>& buffer, std::ostream& out, bool force)
+{
+    if (force || buffer.size() >= BUFFER_SIZE) {
+        out.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "quad_tree.hpp"
+
+/** \brief Writes the image encoded by a QuadTree to a 1 bit per pixel image file.
+ *
+ * Scanlines are generated directly from the tree, one band of rows at a time, \sa
+ * QuadTree::pack_rows(). Memory use is a band of scanlines plus an output buffer, regardless of
+ * the size of the image, and output is handed to the stream in large writes.
+ *
+ * Supported formats are 1 bit per pixel, uncompressed BMP (with a black and white palette), and
+ * binary PBM (P4). */
+class ImageWriter
+{
+public:
+    /** \brief Output file formats. */
+    enum class Format {
+        Bmp, ///< Windows bitmap, 1 bit per pixel, scanlines stored bottom to top
+        Pbm  ///< Netpbm bitmap (P4), scanlines stored top to bottom
+    };
+
+    /** \brief Rows per band when none is passed to the constructor. */
+    static constexpr size_t DEFAULT_BAND_HEIGHT = 256;
+
+    /** \brief Bytes of output buffered before handing them to the stream. */
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+    /** \brief Creates a writer for the given format.
+     *
+     * \param format The format of the files to write.
+     * \param band_height The number of rows generated from the tree at a time. */
+    ImageWriter(Format format, size_t band_height = DEFAULT_BAND_HEIGHT);
+
+    /** \brief Picks the output format from a file name's extension.
+     *
+     * \param file_name The file name, ending in .bmp or .pbm (case sensitive).
+     * \param format Set to the matching format, if any.
+     * \return true iff the extension names a supported format. */
+    static bool format_from_file_name(const std::string& file_name, Format& format);
+
+    /** \brief Writes the image encoded by a tree to a stream.
+     *
+     * \param tree The tree to write.
+     * \param out The stream to write to, which should be opened in binary mode.
+     * \return true iff the tree is valid and the image was written successfully. */
+    bool write(const QuadTree& tree, std::ostream& out) const;
+
+    /** \brief Writes the image encoded by a tree to a file.
+     *
+     * \param tree The tree to write.
+     * \param file_name The path of the file to (over)write.
+     * \return true iff the tree is valid and the file was written successfully. */
+    bool write(const QuadTree& tree, const std::string& file_name) const;
+
+private:
+    Format format_;      ///< Format of the files written
+    size_t band_height_; ///< Number of rows generated at a time
+
+    /** \brief Creates the file header for an image of the given size.
+     *
+     * \param side_length The image's side length, in pixels.
+     * \param stride The number of bytes per scanline in the file.
+     * \return The header bytes, which precede the scanlines. */
+    std::vector<char> make_header(size_t side_length, size_t stride) const;
+
+    /** \brief Appends an unsigned, little endian integer to a buffer.
+     *
+     * \param buffer The buffer to append to.
+     * \param value The value to append.
+     * \param bytes The width of the integer, in bytes. */
+    static void put_le(std::vector<char>& buffer, uint32_t value, size_t bytes);
+
+    /** \brief Hands buffered output to the stream once it reaches BUFFER_SIZE bytes.
+     *
+     * \param buffer The buffered output, cleared once written.
+     * \param out The stream to write to.
+     * \param force Write the buffer regardless of its size. */
+    static void flush(std::vector<char>& buffer, std::ostream& out, bool force);
+};
@@ -0,0 +1,182 @@
+#include "published_tree.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+constexpr size_t PublishedTree::DEFAULT_READER_SLOTS;
+
+PublishedTree::ReadGuard::ReadGuard(std::atomic<uint64_t>* slot, const QuadTree* tree) :
+    slot_(slot),
+    tree_(tree)
+{ }
+
+PublishedTree::ReadGuard::ReadGuard(ReadGuard&& other) :
+    slot_(other.slot_),
+    tree_(other.tree_)
+{
+    other.slot_ = nullptr;
+}
+
+PublishedTree::ReadGuard::~ReadGuard()
+{
+    if (slot_) {
+        slot_->store(0);
+    }
+}
+
+const QuadTree&
+PublishedTree::ReadGuard::get_tree() const
+{
+    return *tree_;
+}
+
+PublishedTree::PublishedTree(size_t reader_slots) :
+    slot_count_(std::max<size_t>(1, reader_slots)),
+    slots_(new Slot[slot_count_]),
+    overflow_(nullptr),
+    epoch_(1),
+    current_(new Version { QuadTree(), 0 })
+{
+    for (size_t ndx = 0; ndx < slot_count_; ++ndx) {
+        slots_[ndx].epoch.store(0);
+    }
+}
+
+PublishedTree::~PublishedTree()
+{
+    delete current_.load();
+    for (auto version : retired_) {
+        delete version;
+    }
+
+    for (auto overflow = overflow_.load(); overflow;) {
+        auto next = overflow->next;
+        delete overflow;
+        overflow = next;
+    }
+}
+
+PublishedTree::ReadGuard
+PublishedTree::read() const
+{
+    // start probing where this thread found a free slot last time
+    thread_local size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+    for (size_t probe = hint; probe != hint + slot_count_; ++probe) {
+        auto& slot = slots_[probe % slot_count_].epoch;
+
+        // record the epoch before loading the version, a writer which replaces it after this
+        // point will see the slot and keep the version alive
+        uint64_t free = 0;
+        if (slot.load(std::memory_order_relaxed) == 0 &&
+            slot.compare_exchange_strong(free, epoch_.load())) {
+            hint = probe;
+            return ReadGuard(&slot, &current_.load()->tree);
+        }
+    }
+
+    // every fixed slot is taken, rather than waiting for one to be released use an overflow slot
+    auto slot = claim_overflow_slot(epoch_.load());
+    return ReadGuard(slot, &current_.load()->tree);
+}
+
+std::atomic<uint64_t>*
+PublishedTree::claim_overflow_slot(uint64_t epoch) const
+{
+    for (auto overflow = overflow_.load(); overflow; overflow = overflow->next) {
+        uint64_t free = 0;
+        if (overflow->slot.epoch.load(std::memory_order_relaxed) == 0 &&
+            overflow->slot.epoch.compare_exchange_strong(free, epoch)) {
+            return &overflow->slot.epoch;
+        }
+    }
+
+    // the new slot is claimed before it is pushed, so no other reader can take it
+    auto overflow = new OverflowSlot;
+    overflow->slot.epoch.store(epoch);
+    overflow->next = overflow_.load();
+    while (!overflow_.compare_exchange_weak(overflow->next, overflow)) { }
+
+    return &overflow->slot.epoch;
+}
+
+QuadTree
+PublishedTree::get_snapshot() const
+{
+    auto guard = read();
+    return guard.get_tree();
+}
+
+void
+PublishedTree::publish(const QuadTree& tree)
+{
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    publish_locked(tree);
+}
+
+bool
+PublishedTree::update(const std::function<QuadTree(const QuadTree&)>& edit)
+{
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+
+    // writers are serialized, so the current version can't be replaced while editing it
+    auto tree = edit(current_.load()->tree);
+    if (!tree.is_valid()) {
+        return false;
+    }
+
+    publish_locked(tree);
+    return true;
+}
+
+void
+PublishedTree::reclaim()
+{
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    reclaim_locked();
+}
+
+size_t
+PublishedTree::get_retired_count() const
+{
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    return retired_.size();
+}
+
+void
+PublishedTree::publish_locked(const QuadTree& tree)
+{
+    // readers which loaded the old version recorded an epoch no later than its retired epoch
+    auto old = current_.exchange(new Version { tree, 0 });
+    old->retired_epoch = epoch_.fetch_add(1);
+    retired_.push_back(old);
+
+    reclaim_locked();
+}
+
+void
+PublishedTree::reclaim_locked()
+{
+    auto oldest_reader = std::numeric_limits<uint64_t>::max();
+    for (size_t ndx = 0; ndx < slot_count_; ++ndx) {
+        auto epoch = slots_[ndx].epoch.load();
+        if (epoch != 0) {
+            oldest_reader = std::min(oldest_reader, epoch);
+        }
+    }
+    for (auto overflow = overflow_.load(); overflow; overflow = overflow->next) {
+        auto epoch = overflow->slot.epoch.load();
+        if (epoch != 0) {
+            oldest_reader = std::min(oldest_reader, epoch);
+        }
+    }
+
+    auto reclaimable = std::partition(retired_.begin(), retired_.end(), [&](Version* version) {
+        return version->retired_epoch >= oldest_reader;
+    });
+    for (auto version = reclaimable; version != retired_.end(); ++version) {
+        delete *version;
+    }
+    retired_.erase(reclaimable, retired_.end());
+}
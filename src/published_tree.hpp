@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "quad_tree.hpp"
+
+/** \brief A QuadTree shared between reader threads and writer threads.
+ *
+ * QuadTrees are persistent, \sa QuadTree, so their const member functions may be called from any
+ * number of threads at once. What needs guarding is the variable holding the current tree, which
+ * writers replace. PublishedTree holds it behind an atomically published pointer:
+ *
+ * - Readers pin the current version with read(), which claims a reader slot and loads the pointer.
+ *   Neither takes a lock, and readers never wait for a writer. Each slot sits on its own cache
+ *   line, so readers on different cores don't contend while reading.
+ * - Writers build a new version off to the side, from a snapshot, and publish() it by exchanging
+ *   the pointer. Writers are serialized with each other, but never with readers.
+ * - Replaced versions are reclaimed by epochs: each publication advances a global epoch, readers
+ *   record the epoch they started in, and a replaced version is deleted once no reader which
+ *   started before its replacement remains.
+ *
+ * Deleting a version only drops its references to the tree's nodes. Snapshots taken from it with
+ * get_snapshot() share those nodes, and remain valid for as long as they are held. */
+class PublishedTree
+{
+public:
+    /** \brief Number of reader slots when none is passed to the constructor. */
+    static constexpr size_t DEFAULT_READER_SLOTS = 64;
+
+    /** \brief A reader's pin on a published version, released on destruction. */
+    class ReadGuard
+    {
+    public:
+        /** \brief Moves a pin, leaving other without one. */
+        ReadGuard(ReadGuard&& other);
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        /** \brief Releases the pin, after which the version may be reclaimed. */
+        ~ReadGuard();
+
+        /** \brief Retrieve the pinned tree.
+         *
+         * \return The tree, which remains valid for the lifetime of this guard. */
+        const QuadTree& get_tree() const;
+
+    private:
+        friend class PublishedTree;
+
+        std::atomic<uint64_t>* slot_; ///< The claimed reader slot, null once moved from
+        const QuadTree* tree_;        ///< The pinned tree
+
+        /** \brief Creates a pin on a tree, from a claimed slot. */
+        ReadGuard(std::atomic<uint64_t>* slot, const QuadTree* tree);
+    };
+
+    /** \brief Creates a published, uninitialized tree.
+     *
+     * \param reader_slots The number of readers which may pin a version from a fixed slot at
+     *        once. Further readers claim an overflow slot, which is allocated the first time it is
+     *        needed and reused afterwards. */
+    explicit PublishedTree(size_t reader_slots = DEFAULT_READER_SLOTS);
+
+    /** \brief Deletes every version. No reader may still hold a ReadGuard. */
+    ~PublishedTree();
+
+    PublishedTree(const PublishedTree&) = delete;
+    PublishedTree& operator=(const PublishedTree&) = delete;
+
+    /** \brief Pins the current version for reading.
+     *
+     * Lock free: a reader only writes its own slot, and never waits for a writer or another
+     * reader. If every fixed slot is taken it claims a free overflow slot, or pushes a new one.
+     *
+     * \return The pin, through which the tree is read. */
+    ReadGuard read() const;
+
+    /** \brief Takes a snapshot of the current version.
+     *
+     * \return A copy of the current tree, which shares its nodes, \sa QuadTree. */
+    QuadTree get_snapshot() const;
+
+    /** \brief Publishes a new version, replacing the current one.
+     *
+     * Readers already holding a pin keep reading the version they pinned. Replaced versions whose
+     * readers are all gone are reclaimed.
+     *
+     * \param tree The tree to publish. */
+    void publish(const QuadTree& tree);
+
+    /** \brief Builds and publishes a new version from the current one.
+     *
+     * Writers are serialized, so no concurrent update is lost. Readers are never blocked while the
+     * edit runs.
+     *
+     * \param edit Builds the new version from a snapshot of the current one.
+     * \return true iff the edit returned a valid tree, which was published. */
+    bool update(const std::function<QuadTree(const QuadTree&)>& edit);
+
+    /** \brief Reclaims every replaced version which no reader still pins. */
+    void reclaim();
+
+    /** \brief Query the number of replaced versions awaiting reclamation. */
+    size_t get_retired_count() const;
+
+private:
+    /** \brief A published version of the tree. */
+    struct Version {
+        QuadTree tree;          ///< The tree
+        uint64_t retired_epoch; ///< The epoch in which this version was replaced
+    };
+
+    /** \brief A reader slot, padded to a cache line so readers don't falsely share slots. */
+    struct Slot {
+        std::atomic<uint64_t> epoch;                       ///< 0 when free, or the reader's epoch
+        char padding[64 - sizeof(std::atomic<uint64_t>)]; ///< Keeps the next slot off this line
+    };
+
+    /** \brief A reader slot beyond the fixed ones, in a list which only grows until destruction. */
+    struct OverflowSlot {
+        Slot slot;          ///< The reader slot
+        OverflowSlot* next; ///< The previously pushed overflow slot, or null
+    };
+
+    size_t slot_count_;                           ///< Number of fixed reader slots
+    std::unique_ptr<Slot[]> slots_;               ///< The fixed reader slots
+    mutable std::atomic<OverflowSlot*> overflow_; ///< The most recently pushed overflow slot
+    std::atomic<uint64_t> epoch_;                 ///< The current epoch, starting at 1
+    std::atomic<Version*> current_;               ///< The current version
+
+    mutable std::mutex writer_mutex_;             ///< Serializes writers, guards retired_
+    std::vector<Version*> retired_;               ///< Replaced versions awaiting reclamation
+
+    /** \brief Claims a reader slot when every fixed one is taken, \sa read().
+     *
+     * \param epoch The epoch to record in the slot.
+     * \return The claimed slot. */
+    std::atomic<uint64_t>* claim_overflow_slot(uint64_t epoch) const;
+
+    /** \brief Publishes a version, the writer lock must be held, \sa publish(). */
+    void publish_locked(const QuadTree& tree);
+
+    /** \brief Reclaims replaced versions, the writer lock must be held, \sa reclaim(). */
+    void reclaim_locked();
+};
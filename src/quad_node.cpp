@@ -1,15 +1,42 @@
 #include "quad_node.hpp"
 
+#include <algorithm>
+#include <bitset>
+
+constexpr size_t QuadNode::BLOCK_SIDE_LENGTH;
+
 QuadNode::QuadNode(size_t side_length, ColorValue color) :
     side_length_(side_length),
     color_(color),
-    was_initialized_(true)
-{ }
+    was_initialized_(true),
+    is_block_(false),
+    block_(0)
+{
+    init_leaf_aggregates();
+}
+
+QuadNode::QuadNode(Block block) :
+    side_length_(BLOCK_SIDE_LENGTH),
+    color_(ColorValue::Mixed),
+    was_initialized_(true),
+    is_block_(true),
+    block_(block)
+{
+    init_leaf_aggregates();
+}
 
 QuadNode::QuadNode() :
     side_length_(0),
     color_(ColorValue::Mixed),
-    was_initialized_(false)
+    was_initialized_(false),
+    is_block_(false),
+    block_(0),
+    black_pixels_(0),
+    hash_(0),
+    black_bounds_{ 0, 0, 0, 0 },
+    node_count_(0),
+    depth_(0),
+    is_subtree_valid_(false)
 { }
 
 void
@@ -18,6 +45,9 @@ QuadNode::init(size_t side_length, ColorValue color)
     side_length_ = side_length;
     color_ = color;
     was_initialized_ = true;
+    is_block_ = false;
+    block_ = 0;
+    init_leaf_aggregates();
 }
 
 size_t
@@ -32,6 +62,36 @@ QuadNode::get_color_value() const
     return color_;
 }
 
+uint64_t
+QuadNode::get_hash() const
+{
+    return hash_;
+}
+
+QuadNode::Bounds
+QuadNode::get_black_bounds() const
+{
+    return black_bounds_;
+}
+
+size_t
+QuadNode::get_node_count() const
+{
+    return node_count_;
+}
+
+size_t
+QuadNode::get_depth() const
+{
+    return depth_;
+}
+
+bool
+QuadNode::is_subtree_valid() const
+{
+    return is_subtree_valid_;
+}
+
 bool
 QuadNode::is_leaf() const
 {
@@ -49,13 +109,51 @@ QuadNode::is_valid() const
         return false;
     }
 
+    if (is_block_) {
+        return is_leaf();
+    }
+
     return is_leaf() || has_valid_children();
 }
 
+bool
+QuadNode::is_block() const
+{
+    return is_block_;
+}
+
+QuadNode::Block
+QuadNode::get_block() const
+{
+    return block_;
+}
+
+size_t
+QuadNode::get_black_pixels() const
+{
+    return black_pixels_;
+}
+
 bool
 QuadNode::set_children(Quad<std::unique_ptr<QuadNode>> children)
 {
-    // use move semantics to obtain ownership of the children
+    return set_children(Quad<std::shared_ptr<QuadNode>>({
+        std::move(children.q1),
+        std::move(children.q2),
+        std::move(children.q3),
+        std::move(children.q4),
+    }));
+}
+
+bool
+QuadNode::set_children(Quad<std::shared_ptr<QuadNode>> children)
+{
+    // blocks store their pixels in place of children
+    if (is_block_) {
+        return false;
+    }
+
+    // use move semantics to obtain (shared) ownership of the children
     children_.q1 = std::move(children.q1);
     children_.q2 = std::move(children.q2);
     children_.q3 = std::move(children.q3);
@@ -68,21 +166,18 @@ QuadNode::set_children(Quad<std::unique_ptr<QuadNode>> children)
         children_.q2.reset();
         children_.q3.reset();
         children_.q4.reset();
+        init_leaf_aggregates();
         return false;
     }
 
+    init_parent_aggregates();
     return true;
 }
 
-QuadNode::Quad<std::shared_ptr<QuadNode>>
+const QuadNode::Quad<std::shared_ptr<QuadNode>>&
 QuadNode::get_children() const
 {
-    return Quad<std::shared_ptr<QuadNode>>({
-        children_.q1,
-        children_.q2,
-        children_.q3,
-        children_.q4,
-    });
+    return children_;
 }
 
 bool
@@ -95,6 +190,109 @@ QuadNode::has_valid_children() const
       children_.q4 && children_.q4.use_count() != 0;
 }
 
+void
+QuadNode::init_leaf_aggregates()
+{
+    black_pixels_ = count_leaf_black_pixels();
+    hash_ = hash_leaf();
+    black_bounds_ = find_leaf_black_bounds();
+    node_count_ = 1;
+    depth_ = 0;
+    is_subtree_valid_ = is_valid();
+}
+
+void
+QuadNode::init_parent_aggregates()
+{
+    const QuadNode* children[] = {
+        children_.q1.get(), children_.q2.get(), children_.q3.get(), children_.q4.get()
+    };
+
+    // quadrant offsets within this node, in Cartesian order
+    uint32_t half = side_length_ / 2;
+    uint32_t x_offsets[] = { half, 0, 0, half };
+    uint32_t y_offsets[] = { 0, 0, half, half };
+
+    black_pixels_ = 0;
+    hash_ = hash_leaf();
+    node_count_ = 1;
+    depth_ = 0;
+    is_subtree_valid_ = is_valid();
+
+    uint32_t x_begin = side_length_, y_begin = side_length_, x_end = 0, y_end = 0;
+    for (size_t ndx = 0; ndx < 4; ++ndx) {
+        const auto& child = *children[ndx];
+        black_pixels_ += child.black_pixels_;
+        hash_ = combine_hash(hash_, child.hash_);
+        node_count_ += child.node_count_;
+        depth_ = std::max(depth_, child.depth_ + 1);
+        is_subtree_valid_ = is_subtree_valid_ && child.is_subtree_valid_;
+
+        // children's bounds are relative to their own quadrants
+        const auto& bounds = child.black_bounds_;
+        if (bounds.width != 0) {
+            x_begin = std::min(x_begin, x_offsets[ndx] + bounds.x);
+            y_begin = std::min(y_begin, y_offsets[ndx] + bounds.y);
+            x_end = std::max(x_end, x_offsets[ndx] + bounds.x + bounds.width);
+            y_end = std::max(y_end, y_offsets[ndx] + bounds.y + bounds.height);
+        }
+    }
+
+    black_bounds_ = x_end == 0 ? Bounds { 0, 0, 0, 0 } :
+        Bounds { x_begin, y_begin, x_end - x_begin, y_end - y_begin };
+}
+
+QuadNode::Bounds
+QuadNode::find_leaf_black_bounds() const
+{
+    if (!is_block_) {
+        uint32_t side = color_ == ColorValue::Black ? side_length_ : 0;
+        return { 0, 0, side, side };
+    }
+
+    uint32_t x_begin = BLOCK_SIDE_LENGTH, y_begin = BLOCK_SIDE_LENGTH, x_end = 0, y_end = 0;
+    for (uint32_t y = 0; y < BLOCK_SIDE_LENGTH; ++y) {
+        for (uint32_t x = 0; x < BLOCK_SIDE_LENGTH; ++x) {
+            if ((block_ >> (y * BLOCK_SIDE_LENGTH + x)) & 1) {
+                x_begin = std::min(x_begin, x);
+                y_begin = std::min(y_begin, y);
+                x_end = std::max(x_end, x + 1);
+                y_end = std::max(y_end, y + 1);
+            }
+        }
+    }
+
+    return x_end == 0 ? Bounds { 0, 0, 0, 0 } :
+        Bounds { x_begin, y_begin, x_end - x_begin, y_end - y_begin };
+}
+
+size_t
+QuadNode::count_leaf_black_pixels() const
+{
+    if (is_block_) {
+        return std::bitset<64>(block_).count();
+    }
+
+    return (color_ == ColorValue::Black) ? side_length_ * side_length_ : 0;
+}
+
+uint64_t
+QuadNode::hash_leaf() const
+{
+    auto hash = combine_hash(side_length_, static_cast<uint64_t>(color_));
+    return is_block_ ? combine_hash(hash, block_) : hash;
+}
+
+uint64_t
+QuadNode::combine_hash(uint64_t seed, uint64_t value)
+{
+    // the splitmix64 finalizer, applied to the seed and value combined as by boost::hash_combine
+    auto hash = seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111eb;
+    return hash ^ (hash >> 31);
+}
+
 bool
 QuadNode::operator==(const QuadNode& other) const
 {
@@ -104,7 +302,9 @@ QuadNode::operator==(const QuadNode& other) const
 
     return
         side_length_ == other.side_length_ &&
-        color_       == other.color_;
+        color_       == other.color_       &&
+        is_block_    == other.is_block_    &&
+        block_       == other.block_;
 }
 
 bool
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 
 /** \brief A QuadNode encodes a single quadrant of the binary image.
@@ -16,23 +17,55 @@
  * set of const member functions.
  *
  * A QuadNode will have 0 children if it is a leaf node, which encodes a homogenous quadrant.
- * Otherwise, it will have 4 children, which can be retrieved via QuadNode::get_children(). */
+ * Otherwise, it will have 4 children, which can be retrieved via QuadNode::get_children().
+ *
+ * Heterogenous quadrants of side BLOCK_SIDE_LENGTH are not split any further. Instead, they are
+ * encoded by a single leaf carrying a bitmask of their pixels, \sa is_block(). This caps the depth
+ * of the tree, and keeps noisy images (halftone, dithering) from producing a node per pixel. */
 class QuadNode
 {
 public:
     /** \brief Each node can represent a Black, White, or Mixed-color quadrant. */
     enum class ColorValue {
-        Mixed, ///< The quadrant contains both black and white pixels, ie. not a leaf
+        Mixed, ///< The quadrant contains both black and white pixels, ie. not a leaf, or a block
         Black,
         White
     };
 
+    /** \brief Bitmask of the pixels in a block, \sa is_block().
+     *
+     * Pixel (x, y) of the block is bit (y * BLOCK_SIDE_LENGTH + x), and is set iff it is black. */
+    using Block = uint64_t;
+
+    /** \brief Bounding box of the black pixels of a quadrant, relative to its top left corner.
+     *
+     * Quadrants without black pixels have empty bounds, of width and height 0. */
+    struct Bounds {
+        uint32_t x;      ///< Column of the left edge
+        uint32_t y;      ///< Row of the top edge
+        uint32_t width;  ///< Width, in pixels
+        uint32_t height; ///< Height, in pixels
+    };
+
+    /** \brief Side length of the quadrants encoded as blocks, \sa is_block(). */
+    static constexpr size_t BLOCK_SIDE_LENGTH = 8;
+    static_assert(BLOCK_SIDE_LENGTH * BLOCK_SIDE_LENGTH == 64,
+            "the block kernels in bit_block.inl assume 8x8 blocks");
+
     /** \brief Creates and initializes a node
      *
      * \param side_length The size of this quadrant's sides.
      * \param color The fill color for this quadrant, or Mixed if its not a leaf node. */
     QuadNode(size_t side_length, ColorValue color);
 
+    /** \brief Creates and initializes a block node, \sa is_block().
+     *
+     * The block should contain both black and white pixels; homogenous quadrants are encoded by
+     * regular leaf nodes.
+     *
+     * \param block The pixels of this BLOCK_SIDE_LENGTH quadrant. */
+    explicit QuadNode(Block block);
+
     /** \brief Creates an uninitialized node.
      *
      * Nodes are lazily initialized via init(). */
@@ -56,6 +89,54 @@ public:
      * \return Fill color for this quadrant. */
     ColorValue get_color_value() const;
 
+    /** \brief Query the number of black pixels in this quadrant.
+     *
+     * The count is cached, so this is O(1) for any node. It is computed when the node is
+     * initialized, for leaves and blocks, and when its children are set, for other nodes.
+     *
+     * \return The number of black pixels encoded by this node and its descendants. */
+    size_t get_black_pixels() const;
+
+    /** \brief Query the bounding box of the black pixels in this quadrant.
+     *
+     * Cached like the black pixel count, and computed from the children's bounds, so transforms
+     * which rebuild parents over rotated or mirrored children remap it in O(1) per node.
+     *
+     * \return The bounds, relative to this quadrant. */
+    Bounds get_black_bounds() const;
+
+    /** \brief Query the number of nodes in this subtree, including this one.
+     *
+     * Cached like the black pixel count. Shared subtrees are counted once per parent.
+     *
+     * \return The number of nodes. */
+    size_t get_node_count() const;
+
+    /** \brief Query the depth of this subtree.
+     *
+     * Cached like the black pixel count.
+     *
+     * \return The number of levels below this node, 0 for a leaf. */
+    size_t get_depth() const;
+
+    /** \brief Query whether this node and all of its descendants are valid, \sa is_valid().
+     *
+     * Cached when the node is initialized and when its children are set, which happens bottom up,
+     * so a tree's validity is known in O(1), \sa QuadTree::is_valid().
+     *
+     * \return true iff every node of this subtree is valid. */
+    bool is_subtree_valid() const;
+
+    /** \brief Query the hash of this quadrant's contents.
+     *
+     * Like the black pixel count, the hash is cached, computed when the node is initialized and
+     * when its children are set. Nodes which are equal, and whose descendants are equal, have
+     * equal hashes, so subtrees encoding the same pixels can be matched without visiting them,
+     * \sa QuadTree::diff().
+     *
+     * \return The hash of this node and its descendants. */
+    uint64_t get_hash() const;
+
     /** \brief Query if a terminal node.
      *
      * Undefined behavior if this node is not valid, \sa is_valid().
@@ -72,6 +153,19 @@ public:
      * \return true iff this node is valid. */
     bool is_valid() const;
 
+    /** \brief Query if this is a block node.
+     *
+     * A block node is a Mixed leaf of side BLOCK_SIDE_LENGTH, which stores its pixels in a bitmask
+     * instead of in children, \sa get_block().
+     *
+     * \return true iff this node encodes its pixels as a block. */
+    bool is_block() const;
+
+    /** \brief Retrieve the pixels of a block node.
+     *
+     * \return The block's pixels, or 0 if this is not a block node, \sa is_block(). */
+    Block get_block() const;
+
     /** \brief Defines a quad of values. */
     template<typename T>
     struct Quad {
@@ -86,7 +180,8 @@ public:
      * By design, there is no child->parent relationship.
      *
      * This call will fail if any of the children are unset (null) or invalid, \sa is_valid(). In
-     * this case, this Node's children will be null (re)initialized.
+     * this case, this Node's children will be null (re)initialized. It also fails for block nodes,
+     * which never have children, \sa is_block().
      *
      * By setting the children, the caller is transferring their ownership to node. Accepting
      * unique_ptr by copy reinforces this contract (see
@@ -98,12 +193,25 @@ public:
      * \return true iff the call succeeded. */
     bool set_children(Quad<std::unique_ptr<QuadNode>> children);
 
+    /** \brief Sets or replaces the children of this node, sharing ownership of them.
+     *
+     * Behaves as set_children(Quad<std::unique_ptr<QuadNode>>), but the children may also be
+     * children of other nodes, or the same node may be passed for several quadrants. Shared nodes
+     * must not be modified afterwards, \sa QuadTree.
+     *
+     * \param children The new children for this node.
+     * \return true iff the call succeeded. */
+    bool set_children(Quad<std::shared_ptr<QuadNode>> children);
+
     /** \brief Retrieve this node's children.
      *
      * The returned children will be null-initialized if this node has no children, \sa is_leaf().
+     * They are returned by reference, so traversals can visit them without touching their
+     * reference counts, which readers of a shared tree would otherwise contend on. Copy a child
+     * only to share it in another tree.
      *
-     * \return The children of this node. */
-    Quad<std::shared_ptr<QuadNode>> get_children() const;
+     * \return The children of this node, valid for as long as this node is. */
+    const Quad<std::shared_ptr<QuadNode>>& get_children() const;
 
     /** \brief Equality comparison.
      *
@@ -113,6 +221,8 @@ public:
      *
      * Results are undefined if either node is invalid.
      *
+     * Block nodes are equal iff their pixels are equal.
+     *
      * \return true iff both nodes are valid and have the same properties. */
     bool operator==(const QuadNode& other) const;
 
@@ -120,9 +230,17 @@ public:
     bool operator!=(const QuadNode& other) const;
 
 private:
-    bool was_initialized_; ///< True iff node was initialized
-    size_t side_length_;   ///< This Node's size, in pixels
-    ColorValue color_;     ///< Pixel color for this node
+    size_t side_length_;    ///< This Node's size, in pixels
+    ColorValue color_;      ///< Pixel color for this node
+    bool was_initialized_;  ///< True iff node was initialized
+    bool is_block_;         ///< True iff node is a block
+    Block block_;           ///< Pixels of a block node, 0 otherwise
+    size_t black_pixels_;   ///< Number of black pixels in this quadrant
+    uint64_t hash_;         ///< Hash of this quadrant's contents
+    Bounds black_bounds_;   ///< Bounding box of the black pixels in this quadrant
+    size_t node_count_;     ///< Number of nodes in this subtree
+    size_t depth_;          ///< Number of levels below this node
+    bool is_subtree_valid_; ///< True iff this node and its descendants are valid
 
     Quad<std::shared_ptr<QuadNode>> children_;    ///< Storage for this Node's Children
 
@@ -130,4 +248,32 @@ private:
      *
      * \return true iff all children references are initialized (not null). */
     bool has_valid_children() const;
+
+    /** \brief Counts this node's black pixels from its own properties, ignoring any children.
+     *
+     * \return The number of black pixels, if this node were a leaf. */
+    size_t count_leaf_black_pixels() const;
+
+    /** \brief Resets the cached aggregates to those of a leaf, ignoring any children. */
+    void init_leaf_aggregates();
+
+    /** \brief Computes the cached aggregates from the children's, \sa set_children(). */
+    void init_parent_aggregates();
+
+    /** \brief Finds the bounding box of this node's own black pixels, ignoring any children.
+     *
+     * \return The bounds, if this node were a leaf. */
+    Bounds find_leaf_black_bounds() const;
+
+    /** \brief Hashes this node's own properties, ignoring any children.
+     *
+     * \return The hash of this node, if it were a leaf. */
+    uint64_t hash_leaf() const;
+
+    /** \brief Mixes a value into a hash.
+     *
+     * \param seed The hash so far.
+     * \param value The value to mix in.
+     * \return The combined hash. */
+    static uint64_t combine_hash(uint64_t seed, uint64_t value);
 };
@@ -1,5 +1,10 @@
 #include "quad_tree.hpp"
 
+#include "bit_block.inl"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
 #include <iostream>
 #include <cmath>
 
@@ -27,64 +32,373 @@ QuadTree::init(const Data& data)
     Rows rows = parse_rows(data);
     auto root = make_node(rows);
 
-    // if its not a homogenous image, we have more work to do
-    if (root->get_color_value() == ColorValue::Mixed) {
+    // if its not a homogenous image or a block, we have more work to do
+    if (root->get_color_value() == ColorValue::Mixed && !root->is_block()) {
         init_recursive(rows, *root);
     }
 
     root_ = std::move(root);
 }
 
+void
+QuadTree::init(const std::vector<Runs>& rows, size_t side_length)
+{
+    root_.reset();
+
+    bool is_power_of_two = side_length != 0 && (side_length & (side_length - 1)) == 0;
+    if (!is_power_of_two || rows.size() > side_length) {
+        return;
+    }
+
+    for (const auto& runs : rows) {
+        for (size_t ndx = 0; ndx < runs.size(); ++ndx) {
+            if (runs[ndx] > side_length || (ndx != 0 && runs[ndx] <= runs[ndx - 1])) {
+                return;
+            }
+        }
+    }
+
+    // link each row to the next one that differs, so identical rows are only visited once
+    RunRows run_rows { rows, std::vector<size_t>(side_length, side_length) };
+    auto row_count = rows.size();
+    for (size_t row = row_count; row-- > 0;) {
+        bool same_as_next = row + 1 < row_count ? rows[row] == rows[row + 1] : rows[row].empty();
+        auto next = row + 1 < side_length ? row + 1 : side_length;
+        run_rows.next_distinct[row] = same_as_next && next < side_length ?
+            run_rows.next_distinct[next] : next;
+    }
+
+    root_ = init_runs_recursive(run_rows, 0, 0, side_length);
+}
+
 bool
 QuadTree::is_valid() const
 {
-    bool root_initialized = root_.use_count() != 0;
-    bool root_valid = root_initialized && root_ && root_->is_valid();
+    // validity is cached bottom up, \sa QuadNode::is_subtree_valid()
+    return root_ && root_->is_subtree_valid();
+}
+
+std::shared_ptr<const QuadNode>
+QuadTree::get_root() const
+{
+    return root_;
+}
 
-    if (!root_valid) {
+size_t
+QuadTree::get_side_length() const
+{
+    if (!is_valid()) {
+        return 0;
+    }
+
+    return root_->get_side_length();
+}
+
+bool
+QuadTree::is_blank() const
+{
+    return is_valid() && root_->get_black_pixels() == 0;
+}
+
+bool
+QuadTree::get_content_bounds(Rect& bounds) const
+{
+    if (!is_valid() || root_->get_black_pixels() == 0) {
         return false;
     }
 
-    if (root_->is_leaf()) {
-        return true;
+    auto black_bounds = root_->get_black_bounds();
+    bounds = { black_bounds.x, black_bounds.y, black_bounds.width, black_bounds.height };
+    return true;
+}
+
+QuadTree
+QuadTree::crop_to_content() const
+{
+    Rect bounds;
+    if (!get_content_bounds(bounds)) {
+        return QuadTree();
     }
 
-    auto children = root_->get_children();
-    return
-        QuadTree(children.q1).is_valid() &&
-        QuadTree(children.q2).is_valid() &&
-        QuadTree(children.q3).is_valid() &&
-        QuadTree(children.q4).is_valid();
+    return crop(bounds);
+}
+
+size_t
+QuadTree::get_node_count() const
+{
+    return is_valid() ? root_->get_node_count() : 0;
+}
+
+size_t
+QuadTree::get_depth() const
+{
+    return is_valid() ? root_->get_depth() : 0;
+}
+
+QuadTree::Data
+QuadTree::decode() const
+{
+    if (!is_valid()) {
+        return { };
+    }
+
+    auto side_length = root_->get_side_length();
+    Data data(side_length * side_length, ColorValue::White);
+    decode_recursive(*root_, 0, 0, side_length, data);
+
+    return data;
+}
+
+QuadTree::Data
+QuadTree::decode(size_t max_depth, Collapse rule) const
+{
+    auto side_length = get_side_length();
+    if (side_length == 0) {
+        return { };
+    }
+
+    size_t lod_side_length = 1;
+    for (size_t depth = 0; depth < max_depth && lod_side_length < side_length; ++depth) {
+        lod_side_length *= 2;
+    }
+
+    Data data(lod_side_length * lod_side_length, ColorValue::White);
+    decode_lod_recursive(
+            *root_, 0, 0, side_length / lod_side_length, rule, lod_side_length, data);
+
+    return data;
+}
+
+QuadTree::Data
+QuadTree::render_thumbnail(size_t side_length, Collapse rule) const
+{
+    auto tree_side_length = get_side_length();
+    if (tree_side_length == 0 || side_length == 0) {
+        return { };
+    }
+
+    size_t depth = 0;
+    size_t lod_side_length = 1;
+    while (lod_side_length < side_length && lod_side_length < tree_side_length) {
+        lod_side_length *= 2;
+        ++depth;
+    }
+
+    auto lod = decode(depth, rule);
+    if (lod_side_length == side_length) {
+        return lod;
+    }
+
+    // sample the level of detail at each thumbnail pixel's center
+    Data thumbnail;
+    thumbnail.reserve(side_length * side_length);
+    for (size_t y = 0; y < side_length; ++y) {
+        auto lod_y = (2 * y + 1) * lod_side_length / (2 * side_length);
+        for (size_t x = 0; x < side_length; ++x) {
+            auto lod_x = (2 * x + 1) * lod_side_length / (2 * side_length);
+            thumbnail.push_back(lod[lod_y * lod_side_length + lod_x]);
+        }
+    }
+
+    return thumbnail;
 }
 
 bool
-QuadTree::operator==(const QuadTree& other) const
+QuadTree::pack_rows(size_t first_row, size_t row_count, size_t stride,
+                    std::vector<uint8_t>& band) const
 {
-    if (!is_valid() || !other.is_valid()) {
+    auto side_length = get_side_length();
+    if (side_length == 0 || first_row + row_count > side_length ||
+        stride < (side_length + 7) / 8) {
         return false;
     }
 
-    // if we get here, we know both tree roots are initialized
-    if (*root_ != *other.root_) {
-        return false;
+    band.assign(row_count * stride, 0);
+    if (row_count != 0) {
+        pack_recursive(*root_, 0, 0, first_row, row_count, stride, band.data());
     }
 
-    if (root_->is_leaf() && other.root_->is_leaf()) {
-        return true;
+    return true;
+}
+
+QuadTree
+QuadTree::rotate(Rotation rotation) const
+{
+    if (!is_valid()) {
+        return QuadTree();
+    }
+
+    return QuadTree(rotate_recursive(root_, rotation));
+}
+
+QuadTree
+QuadTree::flip(Flip flip) const
+{
+    if (!is_valid()) {
+        return QuadTree();
+    }
+
+    return QuadTree(flip_recursive(root_, flip));
+}
+
+ColorValue
+QuadTree::get_pixel(size_t x, size_t y) const
+{
+    auto side_length = get_side_length();
+    if (x >= side_length || y >= side_length) {
+        return ColorValue::Mixed;
+    }
+
+    return get_pixel_recursive(*root_, x, y);
+}
+
+ColorValue
+QuadTree::get_region_color(const Rect& region) const
+{
+    if (!is_valid()) {
+        return ColorValue::Mixed;
+    }
+
+    bool has_black = false;
+    bool has_white = false;
+    collect_region_colors(*root_, 0, 0, region, has_black, has_white);
+
+    if (has_black == has_white) {
+        return ColorValue::Mixed;
+    }
+
+    return has_black ? ColorValue::Black : ColorValue::White;
+}
+
+QuadTree
+QuadTree::rotate_by(double degrees) const
+{
+    if (!is_valid()) {
+        return QuadTree();
+    }
+
+    // rotate the destination back about the image center, ie. counter clockwise
+    auto radians = degrees * M_PI / 180;
+    auto cos_a = cos(radians);
+    auto sin_a = sin(radians);
+    double center = root_->get_side_length() / 2.0;
+
+    Affine inverse = {
+         cos_a, sin_a, center - cos_a * center - sin_a * center,
+        -sin_a, cos_a, center + sin_a * center - cos_a * center
+    };
+
+    return resample(inverse, root_->get_side_length());
+}
+
+QuadTree
+QuadTree::scale(double factor) const
+{
+    if (!is_valid() || !(factor > 0)) {
+        return QuadTree();
+    }
+
+    auto scaled_side_length = std::max(1.0, ceil(root_->get_side_length() * factor));
+    size_t side_length = 1;
+    while (side_length < scaled_side_length) {
+        side_length *= 2;
+    }
+
+    Affine inverse = {
+        1 / factor, 0         , 0,
+        0         , 1 / factor, 0
+    };
+
+    return resample(inverse, side_length);
+}
+
+QuadTree
+QuadTree::with_pixel(size_t x, size_t y, ColorValue color) const
+{
+    auto side_length = get_side_length();
+    if (x >= side_length || y >= side_length || color == ColorValue::Mixed) {
+        return QuadTree();
+    }
+
+    return QuadTree(paint_recursive(root_, x, y, color));
+}
+
+QuadTree
+QuadTree::crop(const Rect& region) const
+{
+    auto source_side_length = get_side_length();
+    if (source_side_length == 0 || region.width == 0 || region.height == 0 ||
+        region.x >= source_side_length || region.width > source_side_length - region.x ||
+        region.y >= source_side_length || region.height > source_side_length - region.y) {
+        return QuadTree();
+    }
+
+    size_t side_length = 1;
+    while (side_length < region.width || side_length < region.height) {
+        side_length *= 2;
     }
 
-    if (root_->is_leaf() != other.root_->is_leaf()) {
+    return QuadTree(shift_recursive(region, region.x, region.y, side_length));
+}
+
+QuadTree
+QuadTree::translate(int64_t dx, int64_t dy) const
+{
+    auto side_length = get_side_length();
+    if (side_length == 0) {
+        return QuadTree();
+    }
+
+    Rect window = { 0, 0, side_length, side_length };
+    return QuadTree(shift_recursive(window, -dx, -dy, side_length));
+}
+
+QuadTree
+QuadTree::dilate(size_t radius) const
+{
+    return morph(Morphology::Dilate, radius);
+}
+
+QuadTree
+QuadTree::erode(size_t radius) const
+{
+    return morph(Morphology::Erode, radius);
+}
+
+QuadTree
+QuadTree::open(size_t radius) const
+{
+    return erode(radius).dilate(radius);
+}
+
+QuadTree
+QuadTree::close(size_t radius) const
+{
+    return dilate(radius).erode(radius);
+}
+
+bool
+QuadTree::diff(const QuadTree& other, std::vector<Rect>& regions) const
+{
+    regions.clear();
+
+    if (!root_ || !other.root_ || !root_->is_valid() || !other.root_->is_valid() ||
+        root_->get_side_length() != other.root_->get_side_length()) {
         return false;
     }
 
-    auto children       = root_->get_children();
-    auto other_children = other.root_->get_children();
+    diff_recursive(*root_, *other.root_, 0, 0, regions);
+    return true;
+}
 
-    return
-        QuadTree(children.q1) == QuadTree(other_children.q1) &&
-        QuadTree(children.q2) == QuadTree(other_children.q2) &&
-        QuadTree(children.q3) == QuadTree(other_children.q3) &&
-        QuadTree(children.q4) == QuadTree(other_children.q4);
+bool
+QuadTree::operator==(const QuadTree& other) const
+{
+    if (!is_valid() || !other.is_valid()) {
+        return false;
+    }
+
+    return equals_recursive(*root_, *other.root_);
 }
 
 bool
@@ -93,6 +407,36 @@ QuadTree::operator!=(const QuadTree& other) const
     return !(*this == other);
 }
 
+bool
+QuadTree::equals_recursive(const QuadNode& node, const QuadNode& other)
+{
+    if (&node == &other) {
+        return true;
+    }
+
+    // structurally equal subtrees always have equal hashes
+    if (node != other || node.get_hash() != other.get_hash()) {
+        return false;
+    }
+
+    if (node.is_leaf() && other.is_leaf()) {
+        return true;
+    }
+
+    if (node.is_leaf() != other.is_leaf()) {
+        return false;
+    }
+
+    const auto& children       = node.get_children();
+    const auto& other_children = other.get_children();
+
+    return
+        equals_recursive(*children.q1, *other_children.q1) &&
+        equals_recursive(*children.q2, *other_children.q2) &&
+        equals_recursive(*children.q3, *other_children.q3) &&
+        equals_recursive(*children.q4, *other_children.q4);
+}
+
 QuadTree::QuadTree(std::shared_ptr<QuadNode> root)
 {
     this->root_ = root;
@@ -168,19 +512,19 @@ QuadTree::init_recursive(const Rows& rows, QuadNode& parent)
     auto quadrants = get_quadrants(rows);
     auto nodes = make_nodes(quadrants);
 
-    if (nodes.q1->get_color_value() == ColorValue::Mixed) {
+    if (nodes.q1->get_color_value() == ColorValue::Mixed && !nodes.q1->is_block()) {
         init_recursive(quadrants.q1, *nodes.q1);
     }
 
-    if (nodes.q2->get_color_value() == ColorValue::Mixed) {
+    if (nodes.q2->get_color_value() == ColorValue::Mixed && !nodes.q2->is_block()) {
         init_recursive(quadrants.q2, *nodes.q2);
     }
 
-    if (nodes.q3->get_color_value() == ColorValue::Mixed) {
+    if (nodes.q3->get_color_value() == ColorValue::Mixed && !nodes.q3->is_block()) {
         init_recursive(quadrants.q3, *nodes.q3);
     }
 
-    if (nodes.q4->get_color_value() == ColorValue::Mixed) {
+    if (nodes.q4->get_color_value() == ColorValue::Mixed && !nodes.q4->is_block()) {
         init_recursive(quadrants.q4, *nodes.q4);
     }
 
@@ -207,5 +551,890 @@ QuadTree::make_node(const Rows& rows)
         return std::unique_ptr<QuadNode>(new QuadNode(side_length, first_color));
     }
 
+    // heterogenous quadrants are not split below the block size
+    if(side_length == QuadNode::BLOCK_SIDE_LENGTH) {
+        return std::unique_ptr<QuadNode>(new QuadNode(parse_block(rows)));
+    }
+
     return std::unique_ptr<QuadNode>(new QuadNode(side_length, ColorValue::Mixed));
 }
+
+std::shared_ptr<QuadNode>
+QuadTree::init_runs_recursive(const RunRows& rows, size_t x_off, size_t y_off, size_t side_length)
+{
+    static const Runs white_row;
+    auto row_runs = [&](size_t row) -> const Runs& {
+        return row < rows.rows.size() ? rows.rows[row] : white_row;
+    };
+
+    // the quadrant is homogenous iff every distinct row within it is, with the same color
+    auto color = get_span_color(row_runs(y_off), x_off, x_off + side_length);
+    for (auto row = rows.next_distinct[y_off];
+         color != ColorValue::Mixed && row < y_off + side_length;
+         row = rows.next_distinct[row]) {
+        if (get_span_color(row_runs(row), x_off, x_off + side_length) != color) {
+            color = ColorValue::Mixed;
+        }
+    }
+
+    if (color != ColorValue::Mixed) {
+        return std::make_shared<QuadNode>(side_length, color);
+    }
+
+    if (side_length == QuadNode::BLOCK_SIDE_LENGTH) {
+        QuadNode::Block block = 0;
+        for (size_t y = 0; y < side_length; ++y) {
+            const auto& runs = row_runs(y_off + y);
+            auto change = std::upper_bound(runs.begin(), runs.end(), x_off);
+            bool is_black = (change - runs.begin()) % 2 == 1;
+            for (auto x = x_off; x < x_off + side_length; ++x) {
+                if (change != runs.end() && *change == x) {
+                    is_black = !is_black;
+                    ++change;
+                }
+                if (is_black) {
+                    block |= QuadNode::Block(1) << (y * side_length + (x - x_off));
+                }
+            }
+        }
+        return std::make_shared<QuadNode>(block);
+    }
+
+    auto half = side_length / 2;
+    return join_quadrants(side_length, {
+        init_runs_recursive(rows, x_off + half, y_off, half),
+        init_runs_recursive(rows, x_off, y_off, half),
+        init_runs_recursive(rows, x_off, y_off + half, half),
+        init_runs_recursive(rows, x_off + half, y_off + half, half)
+    });
+}
+
+ColorValue
+QuadTree::get_span_color(const Runs& runs, size_t x_begin, size_t x_end)
+{
+    // changes at or before x_begin set the span's first color, any change inside it mixes it
+    auto first = std::upper_bound(runs.begin(), runs.end(), x_begin);
+    auto last = std::lower_bound(first, runs.end(), x_end);
+    if (first != last) {
+        return ColorValue::Mixed;
+    }
+
+    return (first - runs.begin()) % 2 == 1 ? ColorValue::Black : ColorValue::White;
+}
+
+void
+QuadTree::decode_recursive(
+        const QuadNode& node, size_t x_off, size_t y_off, size_t side_length, Data& data)
+{
+    auto node_side_length = node.get_side_length();
+
+    if (node.is_block()) {
+        auto block = node.get_block();
+        for (size_t row = 0; row < node_side_length; ++row) {
+            for (size_t col = 0; col < node_side_length; ++col) {
+                bool is_black = (block >> (row * node_side_length + col)) & 1;
+                data[(y_off + row) * side_length + x_off + col] =
+                    is_black ? ColorValue::Black : ColorValue::White;
+            }
+        }
+        return;
+    }
+
+    if (node.is_leaf()) {
+        auto color = node.get_color_value();
+        for (size_t row = y_off; row < y_off + node_side_length; ++row) {
+            auto row_start = data.begin() + row * side_length + x_off;
+            std::fill(row_start, row_start + node_side_length, color);
+        }
+        return;
+    }
+
+    auto half = node_side_length / 2;
+    const auto& children = node.get_children();
+
+    decode_recursive(*children.q1, x_off + half, y_off       , side_length, data);
+    decode_recursive(*children.q2, x_off       , y_off       , side_length, data);
+    decode_recursive(*children.q3, x_off       , y_off + half, side_length, data);
+    decode_recursive(*children.q4, x_off + half, y_off + half, side_length, data);
+}
+
+void
+QuadTree::decode_lod_recursive(const QuadNode& node, size_t x_off, size_t y_off,
+        size_t pixel_size, Collapse rule, size_t side_length, Data& data)
+{
+    auto node_side_length = node.get_side_length();
+
+    // the node fits within a single output pixel
+    if (node_side_length <= pixel_size) {
+        auto color = collapse(node.get_black_pixels(), node_side_length * node_side_length, rule);
+        data[(y_off / pixel_size) * side_length + x_off / pixel_size] = color;
+        return;
+    }
+
+    if (node.is_block()) {
+        // collapse each pixel_size square of the block from the bits under a mask
+        QuadNode::Block row_mask = (QuadNode::Block(1) << pixel_size) - 1;
+        QuadNode::Block square_mask = 0;
+        for (size_t row = 0; row < pixel_size; ++row) {
+            square_mask |= row_mask << (row * node_side_length);
+        }
+
+        for (size_t y = 0; y < node_side_length; y += pixel_size) {
+            for (size_t x = 0; x < node_side_length; x += pixel_size) {
+                auto bits = node.get_block() & (square_mask << (y * node_side_length + x));
+                auto color = collapse(std::bitset<64>(bits).count(), pixel_size * pixel_size, rule);
+                data[((y_off + y) / pixel_size) * side_length + (x_off + x) / pixel_size] = color;
+            }
+        }
+        return;
+    }
+
+    if (node.is_leaf()) {
+        auto color = node.get_color_value();
+        auto out_side_length = node_side_length / pixel_size;
+        for (size_t row = 0; row < out_side_length; ++row) {
+            auto row_start = data.begin() + (y_off / pixel_size + row) * side_length + x_off / pixel_size;
+            std::fill(row_start, row_start + out_side_length, color);
+        }
+        return;
+    }
+
+    auto half = node_side_length / 2;
+    const auto& children = node.get_children();
+
+    decode_lod_recursive(*children.q1, x_off + half, y_off, pixel_size, rule, side_length, data);
+    decode_lod_recursive(*children.q2, x_off, y_off, pixel_size, rule, side_length, data);
+    decode_lod_recursive(*children.q3, x_off, y_off + half, pixel_size, rule, side_length, data);
+    decode_lod_recursive(
+            *children.q4, x_off + half, y_off + half, pixel_size, rule, side_length, data);
+}
+
+ColorValue
+QuadTree::collapse(size_t black_pixels, size_t area, Collapse rule)
+{
+    bool is_black = false;
+    switch (rule) {
+    case Collapse::Majority: is_black = 2 * black_pixels > area; break;
+    case Collapse::AnyBlack: is_black = black_pixels > 0;        break;
+    case Collapse::AllBlack: is_black = black_pixels == area;    break;
+    }
+
+    return is_black ? ColorValue::Black : ColorValue::White;
+}
+
+void
+QuadTree::pack_recursive(const QuadNode& node, size_t x_off, size_t y_off,
+        size_t first_row, size_t row_count, size_t stride, uint8_t* band)
+{
+    auto side_length = node.get_side_length();
+    auto y_begin = std::max(y_off, first_row);
+    auto y_end = std::min(y_off + side_length, first_row + row_count);
+
+    // the band is cleared, ie. white, so only black pixels need writing
+    if (y_begin >= y_end || node.get_color_value() == ColorValue::White) {
+        return;
+    }
+
+    if (node.is_block()) {
+        // blocks are byte aligned, mirrored so their leftmost pixels are the high bits
+        auto mirrored = flip_block_horizontal(node.get_block());
+        for (auto y = y_begin; y < y_end; ++y) {
+            auto byte = uint8_t(mirrored >> ((y - y_off) * side_length));
+            band[(y - first_row) * stride + x_off / 8] = byte;
+        }
+        return;
+    }
+
+    if (node.is_leaf()) {
+        auto x_end = x_off + side_length;
+        auto full_begin = std::min(x_end, (x_off + 7) / 8 * 8);
+        auto full_end = std::max(full_begin, x_end / 8 * 8);
+
+        for (auto y = y_begin; y < y_end; ++y) {
+            auto scanline = band + (y - first_row) * stride;
+            for (auto x = x_off; x < full_begin; ++x) {
+                scanline[x / 8] |= 0x80 >> (x % 8);
+            }
+            std::memset(scanline + full_begin / 8, 0xFF, (full_end - full_begin) / 8);
+            for (auto x = full_end; x < x_end; ++x) {
+                scanline[x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+        return;
+    }
+
+    auto half = side_length / 2;
+    const auto& children = node.get_children();
+
+    pack_recursive(*children.q1, x_off + half, y_off, first_row, row_count, stride, band);
+    pack_recursive(*children.q2, x_off, y_off, first_row, row_count, stride, band);
+    pack_recursive(*children.q3, x_off, y_off + half, first_row, row_count, stride, band);
+    pack_recursive(*children.q4, x_off + half, y_off + half, first_row, row_count, stride, band);
+}
+
+std::shared_ptr<QuadNode>
+QuadTree::rotate_recursive(const std::shared_ptr<QuadNode>& node, Rotation rotation)
+{
+    // homogenous leaves look the same from every angle, so they are shared rather than copied
+    if (rotation == Rotation::None || (node->is_leaf() && !node->is_block())) {
+        return node;
+    }
+
+    if (node->is_block()) {
+        auto block = node->get_block();
+        switch (rotation) {
+        case Rotation::None:                                                 break;
+        case Rotation::Clockwise90:  block = rotate_block_clockwise90(block);  break;
+        case Rotation::Clockwise180: block = rotate_block_clockwise180(block); break;
+        case Rotation::Clockwise270: block = rotate_block_clockwise270(block); break;
+        }
+        return std::make_shared<QuadNode>(block);
+    }
+
+    const auto& children = node->get_children();
+    auto q1 = rotate_recursive(children.q1, rotation);
+    auto q2 = rotate_recursive(children.q2, rotation);
+    auto q3 = rotate_recursive(children.q3, rotation);
+    auto q4 = rotate_recursive(children.q4, rotation);
+
+    auto rotated = std::make_shared<QuadNode>(node->get_side_length(), node->get_color_value());
+
+    // a quarter turn clockwise moves each quadrant to the next one clockwise, ie. NW -> NE
+    switch (rotation) {
+    case Rotation::None:
+        rotated->set_children({q1, q2, q3, q4});
+        break;
+    case Rotation::Clockwise90:
+        rotated->set_children({q2, q3, q4, q1});
+        break;
+    case Rotation::Clockwise180:
+        rotated->set_children({q3, q4, q1, q2});
+        break;
+    case Rotation::Clockwise270:
+        rotated->set_children({q4, q1, q2, q3});
+        break;
+    }
+
+    return rotated;
+}
+
+std::shared_ptr<QuadNode>
+QuadTree::flip_recursive(const std::shared_ptr<QuadNode>& node, Flip flip)
+{
+    // homogenous leaves look the same in a mirror, so they are shared rather than copied
+    if (node->is_leaf() && !node->is_block()) {
+        return node;
+    }
+
+    if (node->is_block()) {
+        auto block = node->get_block();
+        switch (flip) {
+        case Flip::Horizontal: block = flip_block_horizontal(block); break;
+        case Flip::Vertical:   block = flip_block_vertical(block);   break;
+        }
+        return std::make_shared<QuadNode>(block);
+    }
+
+    const auto& children = node->get_children();
+    auto q1 = flip_recursive(children.q1, flip);
+    auto q2 = flip_recursive(children.q2, flip);
+    auto q3 = flip_recursive(children.q3, flip);
+    auto q4 = flip_recursive(children.q4, flip);
+
+    auto flipped = std::make_shared<QuadNode>(node->get_side_length(), node->get_color_value());
+
+    // mirroring swaps the quadrants on either side of the mirror's axis
+    switch (flip) {
+    case Flip::Horizontal:
+        flipped->set_children({q2, q1, q4, q3});
+        break;
+    case Flip::Vertical:
+        flipped->set_children({q4, q3, q2, q1});
+        break;
+    }
+
+    return flipped;
+}
+
+std::shared_ptr<QuadNode>
+QuadTree::paint_recursive(
+        const std::shared_ptr<QuadNode>& node, size_t x, size_t y, ColorValue color)
+{
+    auto side_length = node->get_side_length();
+
+    if (node->is_block()) {
+        auto bit = QuadNode::Block(1) << (y * side_length + x);
+        auto block = (color == ColorValue::Black) ? (node->get_block() | bit)
+                                                  : (node->get_block() & ~bit);
+
+        if (block == node->get_block()) {
+            return node;
+        }
+
+        // keep the tree canonical, a block which became homogenous is a regular leaf
+        if (block == 0) {
+            return std::make_shared<QuadNode>(side_length, ColorValue::White);
+        }
+        if (block == ~QuadNode::Block(0)) {
+            return std::make_shared<QuadNode>(side_length, ColorValue::Black);
+        }
+
+        return std::make_shared<QuadNode>(block);
+    }
+
+    if (node->is_leaf()) {
+        auto leaf_color = node->get_color_value();
+        if (leaf_color == color) {
+            return node;
+        }
+
+        if (side_length == 1) {
+            return std::make_shared<QuadNode>(1, color);
+        }
+
+        if (side_length == QuadNode::BLOCK_SIDE_LENGTH) {
+            auto bit = QuadNode::Block(1) << (y * side_length + x);
+            auto block = (color == ColorValue::Black) ? bit : ~bit;
+            return std::make_shared<QuadNode>(block);
+        }
+
+        // split the leaf, its untouched quadrants all share one node
+        auto quadrant = std::make_shared<QuadNode>(side_length / 2, leaf_color);
+        auto split = std::make_shared<QuadNode>(side_length, ColorValue::Mixed);
+        split->set_children({quadrant, quadrant, quadrant, quadrant});
+        return paint_recursive(split, x, y, color);
+    }
+
+    // copy the path to the pixel, and share every subtree hanging off it
+    auto half = side_length / 2;
+    auto children = node->get_children();
+
+    if (y < half) {
+        if (x < half) {
+            children.q2 = paint_recursive(children.q2, x, y, color);
+        } else {
+            children.q1 = paint_recursive(children.q1, x - half, y, color);
+        }
+    } else {
+        if (x < half) {
+            children.q3 = paint_recursive(children.q3, x, y - half, color);
+        } else {
+            children.q4 = paint_recursive(children.q4, x - half, y - half, color);
+        }
+    }
+
+    const auto& old_children = node->get_children();
+    if (children.q1 == old_children.q1 && children.q2 == old_children.q2 &&
+        children.q3 == old_children.q3 && children.q4 == old_children.q4) {
+        return node;
+    }
+
+    return join_quadrants(side_length, children);
+}
+
+std::shared_ptr<QuadNode>
+QuadTree::join_quadrants(size_t side_length, const Quad<std::shared_ptr<QuadNode>>& children)
+{
+    // keep the tree canonical, 4 identical homogenous quadrants merge into one leaf
+    auto first_color = children.q1->get_color_value();
+    bool homogenous = first_color != ColorValue::Mixed &&
+        children.q1->is_leaf() && children.q2->is_leaf() &&
+        children.q3->is_leaf() && children.q4->is_leaf() &&
+        children.q2->get_color_value() == first_color &&
+        children.q3->get_color_value() == first_color &&
+        children.q4->get_color_value() == first_color;
+
+    if (homogenous) {
+        return std::make_shared<QuadNode>(side_length, first_color);
+    }
+
+    auto parent = std::make_shared<QuadNode>(side_length, ColorValue::Mixed);
+    parent->set_children(children);
+    return parent;
+}
+
+void
+QuadTree::diff_recursive(const QuadNode& node, const QuadNode& other, size_t x_off, size_t y_off,
+        std::vector<Rect>& regions)
+{
+    if (&node == &other || node.get_hash() == other.get_hash()) {
+        return;
+    }
+
+    auto side_length = node.get_side_length();
+    bool is_homogenous = node.is_leaf() && !node.is_block();
+    bool other_is_homogenous = other.is_leaf() && !other.is_block();
+
+    if (is_homogenous && other_is_homogenous) {
+        if (node.get_color_value() != other.get_color_value()) {
+            regions.push_back({ x_off, y_off, side_length, side_length });
+        }
+        return;
+    }
+
+    if (is_homogenous || other_is_homogenous) {
+        const auto& mixed = is_homogenous ? other : node;
+        auto color = is_homogenous ? node.get_color_value() : other.get_color_value();
+        diff_color(mixed, color, x_off, y_off, regions);
+        return;
+    }
+
+    if (node.is_block() || other.is_block()) {
+        auto mask = pack_block(node, 0, 0) ^ pack_block(other, 0, 0);
+        diff_block(mask, side_length, x_off, y_off, regions);
+        return;
+    }
+
+    auto half = side_length / 2;
+    const auto& children = node.get_children();
+    const auto& other_children = other.get_children();
+
+    diff_recursive(*children.q2, *other_children.q2, x_off, y_off, regions);
+    diff_recursive(*children.q1, *other_children.q1, x_off + half, y_off, regions);
+    diff_recursive(*children.q3, *other_children.q3, x_off, y_off + half, regions);
+    diff_recursive(*children.q4, *other_children.q4, x_off + half, y_off + half, regions);
+}
+
+void
+QuadTree::diff_color(const QuadNode& node, ColorValue color, size_t x_off, size_t y_off,
+        std::vector<Rect>& regions)
+{
+    // the cached black pixel count tells whether the whole quadrant matches, or differs
+    auto side_length = node.get_side_length();
+    auto area = side_length * side_length;
+    auto matching = color == ColorValue::Black ? node.get_black_pixels() :
+        area - node.get_black_pixels();
+
+    if (matching == area) {
+        return;
+    }
+
+    if (matching == 0) {
+        regions.push_back({ x_off, y_off, side_length, side_length });
+        return;
+    }
+
+    if (node.is_block()) {
+        auto mask = color == ColorValue::Black ? ~node.get_block() : node.get_block();
+        diff_block(mask, side_length, x_off, y_off, regions);
+        return;
+    }
+
+    auto half = side_length / 2;
+    const auto& children = node.get_children();
+
+    diff_color(*children.q2, color, x_off, y_off, regions);
+    diff_color(*children.q1, color, x_off + half, y_off, regions);
+    diff_color(*children.q3, color, x_off, y_off + half, regions);
+    diff_color(*children.q4, color, x_off + half, y_off + half, regions);
+}
+
+void
+QuadTree::diff_block(QuadNode::Block mask, size_t side_length, size_t x_off, size_t y_off,
+        std::vector<Rect>& regions)
+{
+    for (size_t y = 0; y < side_length; ++y) {
+        auto row = mask >> (y * QuadNode::BLOCK_SIDE_LENGTH);
+        for (size_t x = 0; x < side_length;) {
+            if (!((row >> x) & 1)) {
+                ++x;
+                continue;
+            }
+
+            auto run_start = x;
+            while (x < side_length && ((row >> x) & 1)) {
+                ++x;
+            }
+            regions.push_back({ x_off + run_start, y_off + y, x - run_start, 1 });
+        }
+    }
+}
+
+QuadNode::Block
+QuadTree::pack_block(const QuadNode& node, size_t x_off, size_t y_off)
+{
+    if (node.is_block()) {
+        return node.get_block();
+    }
+
+    auto side_length = node.get_side_length();
+    if (node.is_leaf()) {
+        QuadNode::Block block = 0;
+        if (node.get_color_value() == ColorValue::Black) {
+            for (auto y = y_off; y < y_off + side_length; ++y) {
+                for (auto x = x_off; x < x_off + side_length; ++x) {
+                    block |= QuadNode::Block(1) << (y * QuadNode::BLOCK_SIDE_LENGTH + x);
+                }
+            }
+        }
+        return block;
+    }
+
+    auto half = side_length / 2;
+    const auto& children = node.get_children();
+
+    return
+        pack_block(*children.q1, x_off + half, y_off) |
+        pack_block(*children.q2, x_off, y_off) |
+        pack_block(*children.q3, x_off, y_off + half) |
+        pack_block(*children.q4, x_off + half, y_off + half);
+}
+
+void
+QuadTree::collect_region_colors(const QuadNode& node, size_t x_off, size_t y_off,
+        const Rect& region, bool& has_black, bool& has_white)
+{
+    auto side_length = node.get_side_length();
+
+    // clip the region to this node's quadrant
+    auto x_begin = std::max(x_off, region.x);
+    auto x_end = std::min(x_off + side_length, region.x + region.width);
+    auto y_begin = std::max(y_off, region.y);
+    auto y_end = std::min(y_off + side_length, region.y + region.height);
+
+    if (x_begin >= x_end || y_begin >= y_end || (has_black && has_white)) {
+        return;
+    }
+
+    // a quadrant inside the region is accounted for by its cached black pixel count
+    bool is_covered = x_begin == x_off && x_end == x_off + side_length &&
+                      y_begin == y_off && y_end == y_off + side_length;
+    if (is_covered && (node.is_block() || !node.is_leaf())) {
+        auto black_pixels = node.get_black_pixels();
+        has_black = has_black || black_pixels != 0;
+        has_white = has_white || black_pixels != side_length * side_length;
+        return;
+    }
+
+    if (node.is_block()) {
+        for (auto y = y_begin; y < y_end; ++y) {
+            for (auto x = x_begin; x < x_end; ++x) {
+                auto bit = (y - y_off) * side_length + (x - x_off);
+                bool is_black = (node.get_block() >> bit) & 1;
+                has_black = has_black || is_black;
+                has_white = has_white || !is_black;
+            }
+        }
+        return;
+    }
+
+    if (node.is_leaf()) {
+        has_black = has_black || node.get_color_value() == ColorValue::Black;
+        has_white = has_white || node.get_color_value() == ColorValue::White;
+        return;
+    }
+
+    auto half = side_length / 2;
+    const auto& children = node.get_children();
+
+    collect_region_colors(*children.q1, x_off + half, y_off       , region, has_black, has_white);
+    collect_region_colors(*children.q2, x_off       , y_off       , region, has_black, has_white);
+    collect_region_colors(*children.q3, x_off       , y_off + half, region, has_black, has_white);
+    collect_region_colors(*children.q4, x_off + half, y_off + half, region, has_black, has_white);
+}
+
+std::shared_ptr<QuadNode>
+QuadTree::shift_recursive(
+        const Rect& window, int64_t x_source, int64_t y_source, size_t side_length) const
+{
+    // clip the square to the window, anything outside it is white
+    auto side = int64_t(side_length);
+    auto x_begin = std::max(x_source, int64_t(window.x));
+    auto x_end = std::min(x_source + side, int64_t(window.x + window.width));
+    auto y_begin = std::max(y_source, int64_t(window.y));
+    auto y_end = std::min(y_source + side, int64_t(window.y + window.height));
+
+    if (x_begin >= x_end || y_begin >= y_end) {
+        return std::make_shared<QuadNode>(side_length, ColorValue::White);
+    }
+
+    bool is_inside = x_begin == x_source && x_end == x_source + side &&
+                     y_begin == y_source && y_end == y_source + side;
+
+    // a square lined up with a subtree is shared as is
+    if (is_inside && x_source % side == 0 && y_source % side == 0) {
+        auto subtree = find_subtree(size_t(x_source), size_t(y_source), side_length);
+        if (subtree) {
+            return subtree;
+        }
+    }
+
+    bool has_black = false;
+    bool has_white = !is_inside;
+    Rect clipped = {
+        size_t(x_begin), size_t(y_begin), size_t(x_end - x_begin), size_t(y_end - y_begin)
+    };
+    collect_region_colors(*root_, 0, 0, clipped, has_black, has_white);
+
+    if (!has_black || !has_white) {
+        return std::make_shared<QuadNode>(side_length, has_black ? ColorValue::Black
+                                                                 : ColorValue::White);
+    }
+
+    if (side_length == QuadNode::BLOCK_SIDE_LENGTH) {
+        QuadNode::Block block = 0;
+        for (auto y = y_begin; y < y_end; ++y) {
+            for (auto x = x_begin; x < x_end; ++x) {
+                if (get_pixel_recursive(*root_, size_t(x), size_t(y)) == ColorValue::Black) {
+                    auto bit = (y - y_source) * side + (x - x_source);
+                    block |= QuadNode::Block(1) << bit;
+                }
+            }
+        }
+        return std::make_shared<QuadNode>(block);
+    }
+
+    auto half = side / 2;
+    return join_quadrants(side_length, {
+        shift_recursive(window, x_source + half, y_source       , half),
+        shift_recursive(window, x_source       , y_source       , half),
+        shift_recursive(window, x_source       , y_source + half, half),
+        shift_recursive(window, x_source + half, y_source + half, half)
+    });
+}
+
+std::shared_ptr<QuadNode>
+QuadTree::find_subtree(size_t x, size_t y, size_t side_length) const
+{
+    // walk the tree without taking a reference to each node, only the subtree found is shared
+    const std::shared_ptr<QuadNode>* node = &root_;
+    while ((*node)->get_side_length() > side_length) {
+        if ((*node)->is_block()) {
+            return nullptr;
+        }
+
+        if ((*node)->is_leaf()) {
+            return std::make_shared<QuadNode>(side_length, (*node)->get_color_value());
+        }
+
+        auto half = (*node)->get_side_length() / 2;
+        const auto& children = (*node)->get_children();
+
+        if (y < half) {
+            node = (x < half) ? &children.q2 : &children.q1;
+        } else {
+            node = (x < half) ? &children.q3 : &children.q4;
+        }
+
+        x %= half;
+        y %= half;
+    }
+
+    return *node;
+}
+
+ColorValue
+QuadTree::get_pixel_recursive(const QuadNode& node, size_t x, size_t y)
+{
+    if (node.is_block()) {
+        bool is_black = (node.get_block() >> (y * node.get_side_length() + x)) & 1;
+        return is_black ? ColorValue::Black : ColorValue::White;
+    }
+
+    if (node.is_leaf()) {
+        return node.get_color_value();
+    }
+
+    auto half = node.get_side_length() / 2;
+    const auto& children = node.get_children();
+
+    if (y < half) {
+        return get_pixel_recursive((x < half) ? *children.q2 : *children.q1, x % half, y % half);
+    }
+    return get_pixel_recursive((x < half) ? *children.q3 : *children.q4, x % half, y % half);
+}
+
+QuadTree
+QuadTree::morph(Morphology op, size_t radius) const
+{
+    auto side_length = get_side_length();
+    if (side_length == 0) {
+        return QuadTree();
+    }
+
+    if (radius == 0) {
+        return *this;
+    }
+
+    return QuadTree(morph_recursive(op, radius, 0, 0, side_length));
+}
+
+std::shared_ptr<QuadNode>
+QuadTree::morph_recursive(
+        Morphology op, size_t radius, size_t x_off, size_t y_off, size_t side_length) const
+{
+    // dilation spreads black over white, erosion spreads white over black
+    auto spreading = op == Morphology::Dilate ? ColorValue::Black : ColorValue::White;
+    auto retreating = op == Morphology::Dilate ? ColorValue::White : ColorValue::Black;
+
+    auto image_side_length = root_->get_side_length();
+    auto grow = [&](size_t x, size_t y, size_t side) {
+        auto x_begin = x > radius ? x - radius : 0;
+        auto y_begin = y > radius ? y - radius : 0;
+        auto x_end = std::min(image_side_length, x + side + radius);
+        auto y_end = std::min(image_side_length, y + side + radius);
+        return Rect { x_begin, y_begin, x_end - x_begin, y_end - y_begin };
+    };
+
+    // nothing within reach spreads, or the quadrant is already covered
+    if (!region_contains(grow(x_off, y_off, side_length), spreading)) {
+        return std::make_shared<QuadNode>(side_length, retreating);
+    }
+
+    if (side_length == 1 ||
+        !region_contains({ x_off, y_off, side_length, side_length }, retreating)) {
+        return std::make_shared<QuadNode>(side_length, spreading);
+    }
+
+    if (side_length == QuadNode::BLOCK_SIDE_LENGTH) {
+        QuadNode::Block block = 0;
+        for (size_t y = 0; y < side_length; ++y) {
+            for (size_t x = 0; x < side_length; ++x) {
+                bool is_spread = region_contains(grow(x_off + x, y_off + y, 1), spreading);
+                if (is_spread == (spreading == ColorValue::Black)) {
+                    block |= QuadNode::Block(1) << (y * side_length + x);
+                }
+            }
+        }
+
+        if (block == 0 || block == ~QuadNode::Block(0)) {
+            return std::make_shared<QuadNode>(
+                    side_length, block == 0 ? ColorValue::White : ColorValue::Black);
+        }
+        return std::make_shared<QuadNode>(block);
+    }
+
+    auto half = side_length / 2;
+    return join_quadrants(side_length, {
+        morph_recursive(op, radius, x_off + half, y_off       , half),
+        morph_recursive(op, radius, x_off       , y_off       , half),
+        morph_recursive(op, radius, x_off       , y_off + half, half),
+        morph_recursive(op, radius, x_off + half, y_off + half, half)
+    });
+}
+
+bool
+QuadTree::region_contains(const Rect& region, ColorValue color) const
+{
+    // pretend the other color was already found, so the query stops at the first match
+    bool has_black = color != ColorValue::Black;
+    bool has_white = color != ColorValue::White;
+    collect_region_colors(*root_, 0, 0, region, has_black, has_white);
+
+    return color == ColorValue::Black ? has_black : has_white;
+}
+
+QuadTree
+QuadTree::resample(const Affine& inverse, size_t side_length) const
+{
+    return QuadTree(resample_recursive(inverse, 0, 0, side_length));
+}
+
+std::shared_ptr<QuadNode>
+QuadTree::resample_recursive(
+        const Affine& inverse, size_t x_off, size_t y_off, size_t side_length) const
+{
+    // an affine map takes the quadrant's pixel centers to a parallelogram, bound it by the
+    // mapped corner pixels, with some slack so rounding can't make a sample escape the bounds
+    constexpr double SLACK = 1e-9;
+    double first_x = x_off + 0.5;
+    double last_x = x_off + side_length - 0.5;
+    double first_y = y_off + 0.5;
+    double last_y = y_off + side_length - 0.5;
+
+    double corners_x[] = {first_x, last_x, first_x, last_x};
+    double corners_y[] = {first_y, first_y, last_y, last_y};
+    double min_x = INFINITY, max_x = -INFINITY, min_y = INFINITY, max_y = -INFINITY;
+    for (int ndx = 0; ndx < 4; ++ndx) {
+        auto x = inverse.xx * corners_x[ndx] + inverse.xy * corners_y[ndx] + inverse.x0;
+        auto y = inverse.yx * corners_x[ndx] + inverse.yy * corners_y[ndx] + inverse.y0;
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+    }
+
+    // find the color of the preimage, anything outside the source image is white
+    double source_side = root_->get_side_length();
+    auto x_begin = std::max(0.0, floor(min_x - SLACK));
+    auto x_end = std::min(source_side, floor(max_x + SLACK) + 1);
+    auto y_begin = std::max(0.0, floor(min_y - SLACK));
+    auto y_end = std::min(source_side, floor(max_y + SLACK) + 1);
+
+    bool has_black = false;
+    bool has_white =
+        min_x - SLACK < 0 || min_y - SLACK < 0 ||
+        max_x + SLACK >= source_side || max_y + SLACK >= source_side;
+
+    if (x_begin < x_end && y_begin < y_end) {
+        Rect preimage = {
+            size_t(x_begin), size_t(y_begin), size_t(x_end - x_begin), size_t(y_end - y_begin)
+        };
+        collect_region_colors(*root_, 0, 0, preimage, has_black, has_white);
+    }
+
+    if (!has_black || !has_white) {
+        return std::make_shared<QuadNode>(side_length, has_black ? ColorValue::Black
+                                                                 : ColorValue::White);
+    }
+
+    if (side_length == 1) {
+        return std::make_shared<QuadNode>(1, sample(inverse, x_off, y_off));
+    }
+
+    if (side_length == QuadNode::BLOCK_SIDE_LENGTH) {
+        QuadNode::Block block = 0;
+        for (size_t y = 0; y < side_length; ++y) {
+            for (size_t x = 0; x < side_length; ++x) {
+                if (sample(inverse, x_off + x, y_off + y) == ColorValue::Black) {
+                    block |= QuadNode::Block(1) << (y * side_length + x);
+                }
+            }
+        }
+
+        if (block == 0 || block == ~QuadNode::Block(0)) {
+            return std::make_shared<QuadNode>(
+                    side_length, block == 0 ? ColorValue::White : ColorValue::Black);
+        }
+        return std::make_shared<QuadNode>(block);
+    }
+
+    auto half = side_length / 2;
+    return join_quadrants(side_length, {
+        resample_recursive(inverse, x_off + half, y_off       , half),
+        resample_recursive(inverse, x_off       , y_off       , half),
+        resample_recursive(inverse, x_off       , y_off + half, half),
+        resample_recursive(inverse, x_off + half, y_off + half, half)
+    });
+}
+
+ColorValue
+QuadTree::sample(const Affine& inverse, size_t x, size_t y) const
+{
+    double center_x = x + 0.5;
+    double center_y = y + 0.5;
+    auto source_x = floor(inverse.xx * center_x + inverse.xy * center_y + inverse.x0);
+    auto source_y = floor(inverse.yx * center_x + inverse.yy * center_y + inverse.y0);
+
+    double source_side = root_->get_side_length();
+    if (source_x < 0 || source_y < 0 || source_x >= source_side || source_y >= source_side) {
+        return ColorValue::White;
+    }
+
+    return get_pixel_recursive(*root_, size_t(source_x), size_t(source_y));
+}
+
+QuadNode::Block
+QuadTree::parse_block(const Rows& rows)
+{
+    QuadNode::Block block = 0;
+    for (size_t row = 0; row < rows.size(); ++row) {
+        for (size_t col = 0; col < rows.size(); ++col) {
+            if (rows[row][col] == ColorValue::Black) {
+                block |= QuadNode::Block(1) << (row * rows.size() + col);
+            }
+        }
+    }
+
+    return block;
+}
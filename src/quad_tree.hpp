@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -8,16 +9,60 @@
 /** \brief Encodes a binary image as a quadtree, \ref README.md.
  *
  * On Construction, the QuadTree is empty, and is initialized from the binary image data via init().
- * Clients can check whether initialization was successful via QuadTree::is_valid(). */
+ * Clients can check whether initialization was successful via QuadTree::is_valid().
+ *
+ * QuadTrees are persistent: nodes are never modified once they are part of a tree. Edits and
+ * transforms return a new tree, which copies only the nodes they touch, and shares every other
+ * subtree with the original. Copying a QuadTree is therefore an O(1) snapshot, \sa EditHistory.
+ *
+ * Since published nodes never change, any number of threads may call const member functions on
+ * the same tree at once. Replacing a tree variable while other threads read it is not safe; share
+ * trees which change between threads through a PublishedTree. */
 class QuadTree
 {
 friend class TestableQuadTree;
 
 template<typename T> using Quad = QuadNode::Quad<T>;
-using Data = std::vector<QuadNode::ColorValue>;
-using Rows = std::vector<Data>;
 
 public:
+    /** \brief Contiguous, row-major binary image data, \sa init(). */
+    using Data = std::vector<QuadNode::ColorValue>;
+
+    /** \brief A run-length encoded scanline, \sa init(const std::vector<Runs>&, size_t).
+     *
+     * Lists the columns at which the scanline changes color, in increasing order, starting from
+     * white. For example, { 2, 5 } is a scanline whose pixels 2 to 4 are black. */
+    using Runs = std::vector<size_t>;
+
+    /** \brief Clockwise rotations, in quarter turns, \sa rotate(). */
+    enum class Rotation {
+        None,
+        Clockwise90,
+        Clockwise180,
+        Clockwise270
+    };
+
+    /** \brief Mirror axes, \sa flip(). */
+    enum class Flip {
+        Horizontal, ///< Mirrors left to right
+        Vertical    ///< Mirrors top to bottom
+    };
+
+    /** \brief Rules for collapsing a Mixed quadrant into a single pixel, \sa decode(size_t). */
+    enum class Collapse {
+        Majority, ///< Black iff more than half of the quadrant's pixels are black
+        AnyBlack, ///< Black iff any of the quadrant's pixels are black
+        AllBlack  ///< Black iff all of the quadrant's pixels are black
+    };
+
+    /** \brief An axis-aligned rectangle of pixels. */
+    struct Rect {
+        size_t x;      ///< Column of the rectangle's left edge
+        size_t y;      ///< Row of the rectangle's top edge
+        size_t width;  ///< Width, in pixels
+        size_t height; ///< Height, in pixels
+    };
+
     /** \brief Constructs an unitialized QuadTree.
      *
      * QuadTrees are lazily initialized via init(). */
@@ -35,14 +80,281 @@ public:
      * \param data Binary image data. */
     void init(const Data& data);
 
+    /** \brief Initializes this QuadTree from run-length encoded scanlines.
+     *
+     * The tree is built top down from the runs, without expanding them into pixel data: a
+     * quadrant is a homogenous leaf if none of its rows change color within it, which is found by
+     * a binary search per distinct row, and only mixed 8x8 quadrants are unpacked into blocks.
+     * Runs of identical rows, such as blank margins, are only searched once per quadrant.
+     *
+     * \param rows The scanlines of the image, from the top. Missing rows at the bottom are white.
+     * \param side_length The side length of the image, which must be a power of two. No change
+     *        may lie past it, nor may there be more rows than it.
+     *
+     * If any parameter is out of range, the tree is left uninitialized. */
+    void init(const std::vector<Runs>& rows, size_t side_length);
+
     /** \brief Query validity of this tree.
      *
      * In this context, a tree is valid iff it has been initialized successfully, and all its nodes
-     * are valid. \sa QuadNode::is_valid().
+     * are valid. \sa QuadNode::is_valid(). Validity is cached by the nodes, so this is O(1), \sa
+     * QuadNode::is_subtree_valid().
      *
      * \return true iff this is a valid tree. */
     bool is_valid() const;
 
+    /** \brief Retrieve the root node of this tree.
+     *
+     * Gives algorithms built on top of QuadTree read access to its nodes. Nodes may be shared
+     * with other trees, so they are only exposed as const, \sa QuadNode.
+     *
+     * \return The root node, or null if this tree is uninitialized. */
+    std::shared_ptr<const QuadNode> get_root() const;
+
+    /** \brief Query the size of the encoded image.
+     *
+     * \return The length of the image's sides, or 0 if this tree is invalid. */
+    size_t get_side_length() const;
+
+    /** \brief Query whether the encoded image has no black pixels.
+     *
+     * O(1), from the root's cached black pixel count, \sa QuadNode::get_black_pixels().
+     *
+     * \return true iff this tree is valid and encodes a blank image. */
+    bool is_blank() const;
+
+    /** \brief Query the bounding box of the black pixels of the encoded image.
+     *
+     * O(1), from the root's cached bounds, \sa QuadNode::get_black_bounds().
+     *
+     * \param bounds Set to the bounding box, if there are any black pixels.
+     * \return true iff this tree is valid and has at least one black pixel. */
+    bool get_content_bounds(Rect& bounds) const;
+
+    /** \brief Crops the encoded image to the bounding box of its black pixels, \sa crop().
+     *
+     * \return The cropped tree, or an invalid tree if this tree is invalid or blank. */
+    QuadTree crop_to_content() const;
+
+    /** \brief Query the number of nodes in this tree, \sa QuadNode::get_node_count().
+     *
+     * \return The number of nodes, or 0 if this tree is invalid. */
+    size_t get_node_count() const;
+
+    /** \brief Query the depth of this tree, \sa QuadNode::get_depth().
+     *
+     * \return The number of levels below the root, or 0 if this tree is invalid. */
+    size_t get_depth() const;
+
+    /** \brief Parses the encoded image back into pixel data.
+     *
+     * The returned data is scanned in the same order accepted by init(), so that
+     * `tree.init(data); tree.decode() == data` for any valid square image.
+     *
+     * \return The pixel data encoded by this tree, or empty data if this tree is invalid. */
+    Data decode() const;
+
+    /** \brief Parses a reduced level of detail of the encoded image into pixel data.
+     *
+     * Descends at most max_depth levels into the tree, so the returned image has a side length of
+     * 2^max_depth pixels (at most get_side_length()), each covering a quadrant of the encoded
+     * image. Quadrants which are not homogenous are collapsed into a single pixel by the given
+     * rule, from their cached black pixel count, \sa QuadNode::get_black_pixels().
+     *
+     * The cost is proportional to the size of the returned image, not to that of this tree.
+     *
+     * \param max_depth The depth of the deepest nodes to visit.
+     * \param rule How to choose the color of a Mixed quadrant.
+     * \return The reduced image, or empty data if this tree is invalid. */
+    Data decode(size_t max_depth, Collapse rule = Collapse::Majority) const;
+
+    /** \brief Renders a thumbnail of the encoded image.
+     *
+     * The thumbnail is sampled from the shallowest level of detail at least as large as it, \sa
+     * decode(size_t, Collapse), so its cost is bounded by its own size.
+     *
+     * \param side_length The thumbnail's side length, which need not be a power of two.
+     * \param rule How to choose the color of a Mixed quadrant.
+     * \return The thumbnail's pixel data, or empty data if this tree is invalid or side_length is
+     *         0. */
+    Data render_thumbnail(size_t side_length, Collapse rule = Collapse::Majority) const;
+
+    /** \brief Packs a band of rows of the encoded image into 1 bit per pixel scanlines.
+     *
+     * Pixels are packed most significant bit first, with set bits black, which is the layout of
+     * both PBM and 1 bit per pixel BMP scanlines. Each scanline starts `stride` bytes after the
+     * previous one, and any bits past the end of the image are left clear.
+     *
+     * Only the nodes overlapping the band are visited. Homogenous leaves are written as byte
+     * fills, and blocks a byte per row, so the full image is never materialized.
+     *
+     * \param first_row The first row of the band, counted from the top.
+     * \param row_count The number of rows in the band.
+     * \param stride The number of bytes per scanline, at least (get_side_length() + 7) / 8.
+     * \param band Storage for the scanlines, resized to row_count * stride bytes.
+     * \return true iff the band was packed, false if this tree is invalid, the band is out of
+     *         bounds or the stride is too short. */
+    bool pack_rows(size_t first_row, size_t row_count, size_t stride,
+                   std::vector<uint8_t>& band) const;
+
+    /** \brief Creates a rotated copy of this tree.
+     *
+     * Rotations by quarter turns map onto permutations of each node's children, and block nodes
+     * are rotated with bit manipulation kernels, so no pixel data is parsed. Homogenous leaves look
+     * the same from every angle, so the returned tree shares them with this one rather than
+     * copying them, and Rotation::None returns a tree sharing this one's root. Neither tree may
+     * modify the nodes they share, \sa QuadNode::set_children(); QuadTree never does.
+     *
+     * \param rotation The clockwise rotation to apply.
+     * \return The rotated tree, or an invalid tree if this tree is invalid. */
+    QuadTree rotate(Rotation rotation) const;
+
+    /** \brief Creates a mirrored copy of this tree.
+     *
+     * Like rotate(), mirroring permutes each node's children, block nodes are mirrored with bit
+     * manipulation kernels, \sa QuadNode::is_block(), and homogenous leaves are shared with this
+     * tree.
+     *
+     * \param flip The axis to mirror across.
+     * \return The mirrored tree, or an invalid tree if this tree is invalid. */
+    QuadTree flip(Flip flip) const;
+
+    /** \brief Query the color of a single pixel.
+     *
+     * \param x The pixel's column, counted from the left.
+     * \param y The pixel's row, counted from the top.
+     * \return The pixel's color, or Mixed if this tree is invalid or (x, y) is out of bounds. */
+    QuadNode::ColorValue get_pixel(size_t x, size_t y) const;
+
+    /** \brief Creates a copy of this tree, with a single pixel repainted.
+     *
+     * Only the nodes on the path from the root to the pixel are copied, the returned tree shares
+     * all other subtrees with this one. Nodes are split or merged as needed, so the returned tree
+     * is equal to one initialized from the edited image.
+     *
+     * \param x The pixel's column, counted from the left.
+     * \param y The pixel's row, counted from the top.
+     * \param color The pixel's new color, either Black or White.
+     * \return The edited tree, or an invalid tree if this tree is invalid, (x, y) is out of
+     *         bounds, or color is Mixed. */
+    QuadTree with_pixel(size_t x, size_t y, QuadNode::ColorValue color) const;
+
+    /** \brief Query the color of a rectangular region.
+     *
+     * Only the nodes overlapping the edges of the region are visited, any node inside it is
+     * accounted for as a whole. Parts of the region outside the image are ignored.
+     *
+     * \param region The region to query.
+     * \return Black or White if every pixel of the region within the image has that color, Mixed
+     *         if it contains both, or if this tree is invalid or the region misses the image. */
+    QuadNode::ColorValue get_region_color(const Rect& region) const;
+
+    /** \brief Creates a copy of this tree, rotated by an arbitrary angle.
+     *
+     * The image is rotated about its center, and keeps its side length. Corners rotated in from
+     * outside the image are white, and corners rotated out of it are lost.
+     *
+     * The rotated tree is built top down, by mapping each of its quadrants back into this tree. A
+     * quadrant whose preimage lies within a single color of this tree becomes a leaf without
+     * sampling any pixels, so large homogenous regions cost next to nothing. Remaining pixels are
+     * sampled from their nearest neighbor.
+     *
+     * \param degrees The clockwise rotation to apply, in degrees.
+     * \return The rotated tree, or an invalid tree if this tree is invalid. */
+    QuadTree rotate_by(double degrees) const;
+
+    /** \brief Creates a scaled copy of this tree.
+     *
+     * The scaled image is ceil(factor * get_side_length()) pixels wide, and is padded with white
+     * to the next power of two side length, with the image in the top left corner. Like
+     * rotate_by(), quadrants whose preimage is homogenous are never sampled.
+     *
+     * \param factor The scale factor, which need not be a power of two.
+     * \return The scaled tree, or an invalid tree if this tree is invalid or factor <= 0. */
+    QuadTree scale(double factor) const;
+
+    /** \brief Creates a tree encoding a rectangular part of this image.
+     *
+     * The cropped image has the region's top left corner at its origin, and is padded with white
+     * to the next power of two side length which fits the region, like scale().
+     *
+     * The cropped tree is built top down, like rotate_by(). Quadrants which line up with a subtree
+     * of this tree share it rather than copying it, and homogenous quadrants become leaves after a
+     * region query, so only the nodes straddling the edges of the region are built. Cropping an
+     * aligned page out of a large sheet therefore costs O(depth) nodes.
+     *
+     * \param region The region to crop, which must lie within this image.
+     * \return The cropped tree, or an invalid tree if this tree is invalid, or the region is empty
+     *         or not within this image. */
+    QuadTree crop(const Rect& region) const;
+
+    /** \brief Creates a copy of this tree with the image moved by an offset.
+     *
+     * The image keeps its side length. Pixels moved out of it are lost, and those moved in are
+     * white. Like crop(), quadrants which line up with a subtree of this tree share it, so moving
+     * by a multiple of a large power of two reuses all but the nodes along the seams.
+     *
+     * \param dx The number of columns to move right, or left if negative.
+     * \param dy The number of rows to move down, or up if negative.
+     * \return The moved tree, or an invalid tree if this tree is invalid. */
+    QuadTree translate(int64_t dx, int64_t dy) const;
+
+    /** \brief Creates a copy of this tree with its black pixels dilated.
+     *
+     * A pixel of the dilated image is black iff any pixel of this image within a square of side
+     * 2 * radius + 1 centered on it is black. Pixels outside the image are ignored.
+     *
+     * The dilated tree is built top down, like rotate_by(). A quadrant is white if there is no
+     * black pixel within radius of it, and black if it is black in this image, which region
+     * queries answer for large leaves as a whole. Only the quadrants near the edges between black
+     * and white are split, so the cost tracks the length of those edges rather than the area of
+     * the image.
+     *
+     * \param radius The radius of the square structuring element.
+     * \return The dilated tree, or an invalid tree if this tree is invalid. */
+    QuadTree dilate(size_t radius) const;
+
+    /** \brief Creates a copy of this tree with its black pixels eroded.
+     *
+     * A pixel of the eroded image is black iff every pixel of this image within a square of side
+     * 2 * radius + 1 centered on it is black. Pixels outside the image are ignored. This is the
+     * dual of dilate(), and is built the same way.
+     *
+     * \param radius The radius of the square structuring element.
+     * \return The eroded tree, or an invalid tree if this tree is invalid. */
+    QuadTree erode(size_t radius) const;
+
+    /** \brief Erodes, then dilates, which removes black specks smaller than the element.
+     *
+     * \param radius The radius of the square structuring element.
+     * \return The opened tree, or an invalid tree if this tree is invalid. */
+    QuadTree open(size_t radius) const;
+
+    /** \brief Dilates, then erodes, which fills white holes smaller than the element.
+     *
+     * \param radius The radius of the square structuring element.
+     * \return The closed tree, or an invalid tree if this tree is invalid. */
+    QuadTree close(size_t radius) const;
+
+    /** \brief Finds the regions in which this image differs from another.
+     *
+     * Both trees are walked together, and any pair of subtrees which are the same node, or whose
+     * hashes match, is skipped without being visited, \sa QuadNode::get_hash(). Trees derived from
+     * one another by edits share all untouched subtrees, \sa with_pixel(), and trees built
+     * separately from nearly identical images have matching hashes everywhere but around the
+     * changes, so the cost is proportional to the size of the difference.
+     *
+     * A quadrant which differs as a whole is reported as a single region, and differing pixels
+     * of blocks are reported as runs along their rows. Regions never overlap.
+     *
+     * Only the roots of the trees are checked for validity, to keep the cost independent of the
+     * size of the trees.
+     *
+     * \param other The tree to compare against, which must have the same side length.
+     * \param regions Set to the regions covering exactly the pixels which differ.
+     * \return true iff both trees are valid and have the same side length. */
+    bool diff(const QuadTree& other, std::vector<Rect>& regions) const;
+
     /** \brief Equality comparison.
      *
      * Equality in this context means that both trees encode the same data, ie. the images created
@@ -56,11 +368,32 @@ public:
     /** \brief \sa operator==(). */
     bool operator!=(const QuadTree& other) const;
 
-    /// TODO define interface for applying operations
-
 private:
+    using Rows = std::vector<Data>;
+
+    /** \brief The basic morphology operators, \sa dilate(), erode(). */
+    enum class Morphology {
+        Dilate,
+        Erode
+    };
+
+    /** \brief Maps continuous destination coordinates back to source coordinates.
+     *
+     * source x = xx * x + xy * y + x0
+     * source y = yx * x + yy * y + y0 */
+    struct Affine {
+        double xx, xy, x0;
+        double yx, yy, y0;
+    };
+
     std::shared_ptr<QuadNode> root_; // This tree's root node
 
+    /** \brief Run-length encoded scanlines being built into a tree, \sa init(const std::vector<Runs>&, size_t). */
+    struct RunRows {
+        const std::vector<Runs>& rows;     ///< The scanlines, missing rows are white
+        std::vector<size_t> next_distinct; ///< The next row which differs from each row
+    };
+
     /** \brief Initialize a QuadTree from an existing node.
      *
      * Performs no processing, but accepts the given node as the root of a QuadTree. Useful for
@@ -134,6 +467,8 @@ private:
     static Quad<std::unique_ptr<QuadNode>> make_nodes(const Quad<Rows>& quadrants);
 
     /** \brief Constructs a new node which encodes the given pixel data.
+     *
+     * Heterogenous data of side QuadNode::BLOCK_SIDE_LENGTH is encoded as a block node.
      *
      * \param rows The pixel data to encode.
      * \return A Node which encodes the given pixel data. */
@@ -150,4 +485,250 @@ private:
      * \param rows The pixel data to be encoded.
      * \param parent The parent node the created subtree should be attached to. */
     void init_recursive(const Rows& rows, QuadNode& parent);
+
+    /** \brief Builds the subtree encoding one quadrant of run-length encoded scanlines.
+     *
+     * \param rows The scanlines to encode.
+     * \param x_off x offset of the quadrant within the image
+     * \param y_off y offset of the quadrant within the image
+     * \param side_length The side length of the quadrant.
+     * \return The root of the quadrant's subtree. */
+    static std::shared_ptr<QuadNode> init_runs_recursive(
+            const RunRows& rows, size_t x_off, size_t y_off, size_t side_length);
+
+    /** \brief Finds the color of a span of a run-length encoded scanline.
+     *
+     * \param runs The scanline.
+     * \param x_begin The first column of the span.
+     * \param x_end One past the last column of the span.
+     * \return Black or White if the span has a single color, Mixed otherwise. */
+    static QuadNode::ColorValue get_span_color(const Runs& runs, size_t x_begin, size_t x_end);
+
+    /** \brief Compares two subtrees, \sa operator==().
+     *
+     * \return true iff both subtrees encode the same pixels. */
+    static bool equals_recursive(const QuadNode& node, const QuadNode& other);
+
+    /** \brief Writes the pixels encoded by a subtree into an image.
+     *
+     * \param node The root of the subtree to decode.
+     * \param x_off x offset of the subtree's quadrant within the image
+     * \param y_off y offset of the subtree's quadrant within the image
+     * \param side_length The side length of the image being written.
+     * \param data The image to write into. */
+    static void decode_recursive(
+            const QuadNode& node, size_t x_off, size_t y_off, size_t side_length, Data& data);
+
+    /** \brief Writes a reduced level of detail of a subtree into an image, \sa decode(size_t).
+     *
+     * \param node The root of the subtree to decode.
+     * \param x_off x offset of the subtree's quadrant within the encoded image
+     * \param y_off y offset of the subtree's quadrant within the encoded image
+     * \param pixel_size The side length of the quadrant covered by each output pixel.
+     * \param rule How to choose the color of a Mixed quadrant.
+     * \param side_length The side length of the output image.
+     * \param data The output image. */
+    static void decode_lod_recursive(const QuadNode& node, size_t x_off, size_t y_off,
+            size_t pixel_size, Collapse rule, size_t side_length, Data& data);
+
+    /** \brief Picks the color of a quadrant collapsed into a single pixel.
+     *
+     * \param black_pixels The number of black pixels in the quadrant.
+     * \param area The number of pixels in the quadrant.
+     * \param rule How to choose the color.
+     * \return Black or White. */
+    static QuadNode::ColorValue collapse(size_t black_pixels, size_t area, Collapse rule);
+
+    /** \brief Packs the rows of a subtree that overlap a band, \sa pack_rows().
+     *
+     * \param node The root of the subtree to pack.
+     * \param x_off x offset of the subtree's quadrant within the image
+     * \param y_off y offset of the subtree's quadrant within the image
+     * \param first_row The first row of the band.
+     * \param row_count The number of rows in the band.
+     * \param stride The number of bytes per scanline.
+     * \param band The band's scanlines, which must be cleared beforehand. */
+    static void pack_recursive(const QuadNode& node, size_t x_off, size_t y_off,
+            size_t first_row, size_t row_count, size_t stride, uint8_t* band);
+
+    /** \brief Creates a rotated copy of a subtree.
+     *
+     * Homogenous leaves are shared with the original subtree.
+     *
+     * \param node The root of the subtree to rotate.
+     * \param rotation The clockwise rotation to apply.
+     * \return The root of the rotated copy. */
+    static std::shared_ptr<QuadNode> rotate_recursive(
+            const std::shared_ptr<QuadNode>& node, Rotation rotation);
+
+    /** \brief Creates a mirrored copy of a subtree.
+     *
+     * Homogenous leaves are shared with the original subtree.
+     *
+     * \param node The root of the subtree to mirror.
+     * \param flip The axis to mirror across.
+     * \return The root of the mirrored copy. */
+    static std::shared_ptr<QuadNode> flip_recursive(
+            const std::shared_ptr<QuadNode>& node, Flip flip);
+
+    /** \brief Creates a copy of a subtree, with a single pixel repainted, \sa with_pixel().
+     *
+     * \param node The root of the subtree to paint.
+     * \param x The pixel's column within the subtree's quadrant.
+     * \param y The pixel's row within the subtree's quadrant.
+     * \param color The pixel's new color.
+     * \return The root of the painted subtree, which is node itself if the pixel already had the
+     *         given color. */
+    static std::shared_ptr<QuadNode> paint_recursive(
+            const std::shared_ptr<QuadNode>& node, size_t x, size_t y, QuadNode::ColorValue color);
+
+    /** \brief Joins 4 quadrants under a new parent node.
+     *
+     * Keeps the tree canonical: if all 4 quadrants are homogenous leaves of the same color, a
+     * single leaf is returned in their place.
+     *
+     * \param side_length The side length of the parent.
+     * \param children The quadrants to join.
+     * \return The parent node, or the merged leaf. */
+    static std::shared_ptr<QuadNode> join_quadrants(
+            size_t side_length, const Quad<std::shared_ptr<QuadNode>>& children);
+
+    /** \brief Finds the regions in which two subtrees differ, \sa diff().
+     *
+     * \param node The root of one subtree.
+     * \param other The root of the other subtree, of the same side length.
+     * \param x_off x offset of the subtrees' quadrant within the image
+     * \param y_off y offset of the subtrees' quadrant within the image
+     * \param regions The differing regions, appended to. */
+    static void diff_recursive(const QuadNode& node, const QuadNode& other, size_t x_off,
+            size_t y_off, std::vector<Rect>& regions);
+
+    /** \brief Finds the regions in which a subtree differs from a single color, \sa diff().
+     *
+     * \param node The root of the subtree.
+     * \param color The color to compare against, Black or White.
+     * \param x_off x offset of the subtree's quadrant within the image
+     * \param y_off y offset of the subtree's quadrant within the image
+     * \param regions The differing regions, appended to. */
+    static void diff_color(const QuadNode& node, QuadNode::ColorValue color, size_t x_off,
+            size_t y_off, std::vector<Rect>& regions);
+
+    /** \brief Reports the set bits of a block's difference mask as runs along its rows.
+     *
+     * \param mask The differing pixels, laid out as in QuadNode::Block.
+     * \param side_length The side length of the quadrant the mask covers.
+     * \param x_off x offset of the quadrant within the image
+     * \param y_off y offset of the quadrant within the image
+     * \param regions The differing regions, appended to. */
+    static void diff_block(QuadNode::Block mask, size_t side_length, size_t x_off, size_t y_off,
+            std::vector<Rect>& regions);
+
+    /** \brief Packs the pixels of a subtree no larger than a block into a block's layout.
+     *
+     * \param node The root of the subtree.
+     * \param x_off x offset of the subtree's quadrant within the block
+     * \param y_off y offset of the subtree's quadrant within the block
+     * \return The subtree's black pixels, laid out as in QuadNode::Block. */
+    static QuadNode::Block pack_block(const QuadNode& node, size_t x_off, size_t y_off);
+
+    /** \brief Collects the colors of the pixels of a subtree within a region.
+     *
+     * Stops descending as soon as both colors have been found.
+     *
+     * \param node The root of the subtree.
+     * \param x_off x offset of the subtree's quadrant within the image
+     * \param y_off y offset of the subtree's quadrant within the image
+     * \param region The region to query, which must lie within the image.
+     * \param has_black Set to true if a black pixel is found.
+     * \param has_white Set to true if a white pixel is found. */
+    static void collect_region_colors(const QuadNode& node, size_t x_off, size_t y_off,
+            const Rect& region, bool& has_black, bool& has_white);
+
+    /** \brief Builds one quadrant of a cropped or moved tree, \sa crop(), translate().
+     *
+     * The quadrant is a copy of the square of this image at (x_source, y_source), in which
+     * pixels outside the window, or outside this image, are white.
+     *
+     * \param window The pixels of this image to copy, which must lie within it.
+     * \param x_source Column of the square's left edge in this image, may be negative.
+     * \param y_source Row of the square's top edge in this image, may be negative.
+     * \param side_length The side length of the quadrant.
+     * \return The root of the quadrant's subtree. */
+    std::shared_ptr<QuadNode> shift_recursive(
+            const Rect& window, int64_t x_source, int64_t y_source, size_t side_length) const;
+
+    /** \brief Finds the subtree encoding an aligned square of this image.
+     *
+     * \param x Column of the square's left edge, a multiple of side_length.
+     * \param y Row of the square's top edge, a multiple of side_length.
+     * \param side_length The side length of the square.
+     * \return The subtree, a new leaf if the square lies within a larger homogenous leaf, or null
+     *         if it lies within a block. */
+    std::shared_ptr<QuadNode> find_subtree(size_t x, size_t y, size_t side_length) const;
+
+    /** \brief Finds the color of a single pixel of a subtree, \sa get_pixel().
+     *
+     * \param node The root of the subtree.
+     * \param x The pixel's column within the subtree's quadrant.
+     * \param y The pixel's row within the subtree's quadrant.
+     * \return The pixel's color. */
+    static QuadNode::ColorValue get_pixel_recursive(const QuadNode& node, size_t x, size_t y);
+
+    /** \brief Applies a basic morphology operator, \sa dilate(), erode().
+     *
+     * \param op The operator to apply.
+     * \param radius The radius of the square structuring element.
+     * \return The resulting tree, or an invalid tree if this tree is invalid. */
+    QuadTree morph(Morphology op, size_t radius) const;
+
+    /** \brief Builds one quadrant of a dilated or eroded tree, \sa morph().
+     *
+     * \param op The operator to apply.
+     * \param radius The radius of the square structuring element.
+     * \param x_off x offset of the quadrant within the image
+     * \param y_off y offset of the quadrant within the image
+     * \param side_length The side length of the quadrant.
+     * \return The root of the quadrant's subtree. */
+    std::shared_ptr<QuadNode> morph_recursive(
+            Morphology op, size_t radius, size_t x_off, size_t y_off, size_t side_length) const;
+
+    /** \brief Query whether a region of this image contains a color.
+     *
+     * \param region The region to query, which must lie within this image.
+     * \param color The color to look for, Black or White.
+     * \return true iff any pixel of the region has the color. */
+    bool region_contains(const Rect& region, QuadNode::ColorValue color) const;
+
+    /** \brief Builds a new tree by inverse-mapping each of its pixels into this one.
+     *
+     * Source pixels outside this image are white.
+     *
+     * \param inverse Maps destination pixel coordinates into this tree.
+     * \param side_length The side length of the new tree.
+     * \return The resampled tree. */
+    QuadTree resample(const Affine& inverse, size_t side_length) const;
+
+    /** \brief Builds one quadrant of a resampled tree, \sa resample().
+     *
+     * \param inverse Maps destination pixel coordinates into this tree.
+     * \param x_off x offset of the quadrant within the destination image
+     * \param y_off y offset of the quadrant within the destination image
+     * \param side_length The side length of the quadrant.
+     * \return The root of the quadrant's subtree. */
+    std::shared_ptr<QuadNode> resample_recursive(
+            const Affine& inverse, size_t x_off, size_t y_off, size_t side_length) const;
+
+    /** \brief Samples the source pixel nearest to a destination pixel's center.
+     *
+     * \param inverse Maps destination pixel coordinates into this tree.
+     * \param x The destination pixel's column.
+     * \param y The destination pixel's row.
+     * \return The sampled color, White if it falls outside this image. */
+    QuadNode::ColorValue sample(const Affine& inverse, size_t x, size_t y) const;
+
+    /** \brief Packs pixel data into a block, \sa QuadNode::Block.
+     *
+     * \param rows The QuadNode::BLOCK_SIDE_LENGTH rows of pixel data to pack.
+     * \return The packed block. */
+    static QuadNode::Block parse_block(const Rows& rows);
 };
@@ -0,0 +1,288 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <sys/resource.h>
+
+#include "image_reader.hpp"
+
+using namespace testing;
+using C = QuadNode::ColorValue;
+
+/** \brief Generates the images of the corpus, which span the shapes of tree a page can produce.
+ *
+ * Each image is generated at any power of two side length, so the same corpus serves both the
+ * round trip checks and the throughput gate. Random images are seeded, so runs are repeatable. */
+class TestableCorpus : public Test
+{
+protected:
+    /** \brief The kinds of image in the corpus. */
+    static std::vector<std::string> get_names()
+    {
+        return { "blank", "noise", "checkerboard", "text", "skyline" };
+    }
+
+    /** \brief Generates one image of the corpus.
+     *
+     * \param name The kind of image, \sa get_names().
+     * \param side_length The side length of the image, a power of two of at least 256.
+     * \return The image's pixels, in rows. */
+    static QuadTree::Data make_image(const std::string& name, size_t side_length)
+    {
+        if (name == "noise") {
+            return make_noise(side_length);
+        }
+        if (name == "checkerboard") {
+            return make_checkerboard(side_length);
+        }
+        if (name == "text") {
+            return make_text(side_length);
+        }
+        if (name == "skyline") {
+            return make_skyline(side_length);
+        }
+        return QuadTree::Data(side_length * side_length, C::White);
+    }
+
+    /** \brief Uniform random pixels, which leave every 8x8 block mixed but differing. */
+    static QuadTree::Data make_noise(size_t side_length)
+    {
+        std::mt19937 random(side_length);
+        QuadTree::Data data(side_length * side_length);
+        for (auto& pixel : data) {
+            pixel = (random() & 1) ? C::Black : C::White;
+        }
+        return data;
+    }
+
+    /** \brief Alternating pixels, the worst case, with no homogenous quadrant above a pixel. */
+    static QuadTree::Data make_checkerboard(size_t side_length)
+    {
+        QuadTree::Data data(side_length * side_length);
+        for (size_t y = 0; y < side_length; ++y) {
+            for (size_t x = 0; x < side_length; ++x) {
+                data[y * side_length + x] = ((x ^ y) & 1) ? C::Black : C::White;
+            }
+        }
+        return data;
+    }
+
+    /** \brief Lines of small, randomly shaped glyphs between wide margins, like a scanned page. */
+    static QuadTree::Data make_text(size_t side_length)
+    {
+        std::mt19937 random(side_length + 1);
+        QuadTree::Data data(side_length * side_length, C::White);
+
+        auto margin = side_length / 8;
+        for (auto line = margin; line + 12 < side_length - margin; line += 24) {
+            for (auto glyph = margin; glyph + 6 < side_length - margin; glyph += 8) {
+                // leave a space between words, and set some of each glyph's 5x9 pixels
+                if (random() % 6 == 0) {
+                    continue;
+                }
+                for (size_t y = 0; y < 9; ++y) {
+                    for (size_t x = 0; x < 5; ++x) {
+                        if (random() % 3 == 0) {
+                            data[(line + y) * side_length + glyph + x] = C::Black;
+                        }
+                    }
+                }
+            }
+        }
+        return data;
+    }
+
+    /** \brief The sample bitmap, scaled up to the image's size. */
+    static QuadTree::Data make_skyline(size_t side_length)
+    {
+        QuadTree tree;
+        if (!ImageReader::read(SOURCE_DIR "/london-skyline.bmp", tree)) {
+            return { };
+        }
+        return tree.scale(double(side_length) / tree.get_side_length()).decode();
+    }
+
+    /** \brief Rotates square pixel data a quarter turn clockwise, one pixel at a time. */
+    static QuadTree::Data rotate_pixels(const QuadTree::Data& data, size_t side_length)
+    {
+        QuadTree::Data rotated(data.size());
+        for (size_t y = 0; y < side_length; ++y) {
+            for (size_t x = 0; x < side_length; ++x) {
+                rotated[x * side_length + (side_length - 1 - y)] = data[y * side_length + x];
+            }
+        }
+        return rotated;
+    }
+};
+
+class RoundTrips : public TestableCorpus
+{
+protected:
+    static constexpr size_t SIDE_LENGTH = 1024;
+};
+
+constexpr size_t RoundTrips::SIDE_LENGTH;
+
+TEST_F(RoundTrips, BuildThenDecode_ReturnsTheImage)
+{
+    for (const auto& name : get_names()) {
+        auto data = make_image(name, SIDE_LENGTH);
+        ASSERT_EQ(SIDE_LENGTH * SIDE_LENGTH, data.size()) << name;
+
+        QuadTree tree;
+        tree.init(data);
+        ASSERT_TRUE(tree.is_valid()) << name;
+        EXPECT_TRUE(tree.decode() == data) << name;
+    }
+}
+
+TEST_F(RoundTrips, Rotations_MatchRotatedPixels)
+{
+    for (const auto& name : get_names()) {
+        auto data = make_image(name, SIDE_LENGTH);
+        QuadTree tree;
+        tree.init(data);
+
+        auto rotated = tree.rotate(QuadTree::Rotation::Clockwise90);
+        EXPECT_TRUE(rotated.decode() == rotate_pixels(data, SIDE_LENGTH)) << name;
+
+        // four quarter turns are the identity
+        auto turned = tree;
+        for (size_t turn = 0; turn < 4; ++turn) {
+            turned = turned.rotate(QuadTree::Rotation::Clockwise90);
+        }
+        EXPECT_TRUE(turned == tree) << name;
+        EXPECT_EQ(tree.get_node_count(), turned.get_node_count()) << name;
+    }
+}
+
+TEST_F(RoundTrips, RunLengths_BuildTheSameTree)
+{
+    for (const auto& name : get_names()) {
+        auto data = make_image(name, SIDE_LENGTH);
+        QuadTree tree;
+        tree.init(data);
+
+        std::vector<QuadTree::Runs> rows(SIDE_LENGTH);
+        for (size_t y = 0; y < SIDE_LENGTH; ++y) {
+            auto color = C::White;
+            for (size_t x = 0; x < SIDE_LENGTH; ++x) {
+                if (data[y * SIDE_LENGTH + x] != color) {
+                    rows[y].push_back(x);
+                    color = data[y * SIDE_LENGTH + x];
+                }
+            }
+        }
+
+        QuadTree from_runs;
+        from_runs.init(rows, SIDE_LENGTH);
+        EXPECT_TRUE(from_runs == tree) << name;
+    }
+}
+
+/** \brief Gates the throughput and memory use of whole-image operations on a stored baseline.
+ *
+ * The baseline file lists the minimum throughput, in megapixels per second, of each operation
+ * on each image of the corpus, and the budget for the peak resident set size of the process.
+ * Each operation is timed as the best of a few runs, to be robust to a busy machine, and its
+ * throughput is printed in the file's format so the baseline can be refreshed. */
+class Throughput : public TestableCorpus
+{
+protected:
+    static constexpr size_t SIDE_LENGTH = 4096;
+    static constexpr size_t RUNS = 3;
+
+    std::map<std::string, double> baseline;
+
+    void SetUp() override
+    {
+        std::ifstream file(PERF_BASELINE);
+        ASSERT_TRUE(file.good()) << "unable to read " PERF_BASELINE;
+
+        std::string line;
+        while (std::getline(file, line)) {
+            auto comment = line.find('#');
+            std::istringstream fields(line.substr(0, comment));
+            std::string name;
+            std::string op;
+            double value;
+            if (fields >> name >> op >> value) {
+                baseline[name + " " + op] = value;
+            }
+        }
+    }
+
+    /** \brief Times an operation over one image, and checks its throughput against the baseline.
+     *
+     * \param name The kind of image.
+     * \param op The name of the operation.
+     * \param run Performs the operation once. */
+    template<typename Operation>
+    void gate(const std::string& name, const std::string& op, Operation run)
+    {
+        using Clock = std::chrono::steady_clock;
+        auto best = Clock::duration::max();
+        for (size_t ndx = 0; ndx < RUNS; ++ndx) {
+            auto start = Clock::now();
+            run();
+            best = std::min(best, Clock::now() - start);
+        }
+
+        double seconds = std::chrono::duration<double>(best).count();
+        double mpx_per_second = SIDE_LENGTH * SIDE_LENGTH / 1e6 / std::max(seconds, 1e-9);
+        std::cout << name << " " << op << " " << mpx_per_second << std::endl;
+
+        auto found = baseline.find(name + " " + op);
+        if (found == baseline.end()) {
+            ADD_FAILURE() << "no baseline for " << name << " " << op;
+            return;
+        }
+        EXPECT_GE(mpx_per_second, found->second) << name << " " << op << " regressed";
+    }
+
+    /** \brief The peak resident set size of the process so far, in megabytes. */
+    static double get_peak_rss()
+    {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / 1024.0;
+    }
+};
+
+constexpr size_t Throughput::SIDE_LENGTH;
+constexpr size_t Throughput::RUNS;
+
+TEST_F(Throughput, BuildRotateDecode_MeetBaseline)
+{
+    auto budget = baseline.find("peak rss_mb");
+    ASSERT_NE(baseline.end(), budget) << "no peak rss_mb budget";
+
+    for (const auto& name : get_names()) {
+        auto data = make_image(name, SIDE_LENGTH);
+        ASSERT_EQ(SIDE_LENGTH * SIDE_LENGTH, data.size()) << name;
+
+        QuadTree tree;
+        gate(name, "build", [&] { tree.init(data); });
+        ASSERT_TRUE(tree.is_valid()) << name;
+
+        QuadTree rotated;
+        gate(name, "rotate", [&] { rotated = tree.rotate(QuadTree::Rotation::Clockwise90); });
+
+        QuadTree::Data decoded;
+        gate(name, "decode", [&] { decoded = rotated.decode(); });
+
+        // the timed results must still be right, or a fast regression would pass the gate
+        EXPECT_TRUE(decoded == rotate_pixels(data, SIDE_LENGTH)) << name;
+    }
+
+    std::cout << "peak rss_mb " << get_peak_rss() << std::endl;
+    EXPECT_LE(get_peak_rss(), budget->second) << "peak resident set size exceeds its budget";
+}
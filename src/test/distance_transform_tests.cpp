@@ -0,0 +1,124 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+#include "distance_transform.hpp"
+
+using namespace testing;
+using C = QuadNode::ColorValue;
+using Point = DistanceTransform::Point;
+
+class TestableDistanceTransform : public Test
+{
+protected:
+    QuadTree tree;
+
+    /** \brief Creates a mostly white image with sparse black specks and a solid black square. */
+    static QuadTree::Data make_drawing(size_t side_length)
+    {
+        QuadTree::Data data(side_length * side_length, C::White);
+        for (size_t ndx = 7; ndx < data.size(); ndx += 211) {
+            data[ndx] = C::Black;
+        }
+        for (size_t y = side_length / 2; y < side_length * 3 / 4; ++y) {
+            for (size_t x = side_length / 4; x < side_length / 2; ++x) {
+                data[y * side_length + x] = C::Black;
+            }
+        }
+        return data;
+    }
+
+    /** \brief Measures the distance from each pixel to each black pixel, one pixel at a time. */
+    static std::vector<double> measure_pixels(const QuadTree::Data& data)
+    {
+        int64_t side_length = sqrt(data.size());
+        std::vector<double> distances(data.size(), std::numeric_limits<double>::infinity());
+        for (int64_t ndx = 0; ndx < int64_t(data.size()); ++ndx) {
+            for (int64_t black = 0; black < int64_t(data.size()); ++black) {
+                if (data[black] == C::Black) {
+                    auto dx = double(ndx % side_length - black % side_length);
+                    auto dy = double(ndx / side_length - black / side_length);
+                    distances[ndx] = std::min(distances[ndx], std::sqrt(dx * dx + dy * dy));
+                }
+            }
+        }
+        return distances;
+    }
+};
+
+class Nearest : public TestableDistanceTransform { };
+
+TEST_F(Nearest, InvalidQueries_FindNothing)
+{
+    Point nearest;
+    EXPECT_FALSE(DistanceTransform::find_nearest_black(tree, { 0, 0 }, nearest));
+
+    tree.init(QuadTree::Data(16 * 16, C::White));
+    EXPECT_FALSE(DistanceTransform::find_nearest_black(tree, { 0, 0 }, nearest));
+    EXPECT_EQ(std::numeric_limits<double>::infinity(), DistanceTransform::get_distance(tree, { 0, 0 }));
+
+    tree.init(QuadTree::Data(16 * 16, C::Black));
+    EXPECT_FALSE(DistanceTransform::find_nearest_black(tree, { 16, 0 }, nearest));
+}
+
+TEST_F(Nearest, FindsTheNearestPixelOfABlackLeaf)
+{
+    auto data = QuadTree::Data(64 * 64, C::White);
+    for (size_t y = 32; y < 64; ++y) {
+        std::fill(data.begin() + y * 64 + 32, data.begin() + y * 64 + 64, C::Black);
+    }
+    tree.init(data);
+
+    Point nearest;
+    ASSERT_TRUE(DistanceTransform::find_nearest_black(tree, { 40, 3 }, nearest));
+    EXPECT_EQ(40, nearest.x);
+    EXPECT_EQ(32, nearest.y);
+    EXPECT_EQ(0, DistanceTransform::get_distance(tree, { 50, 50 }));
+    EXPECT_DOUBLE_EQ(std::sqrt(2.0 * 32 * 32), DistanceTransform::get_distance(tree, { 0, 0 }));
+}
+
+TEST_F(Nearest, MatchesMeasuringPixels)
+{
+    auto data = make_drawing(64);
+    tree.init(data);
+    auto expected = measure_pixels(data);
+
+    for (size_t y = 0; y < 64; y += 3) {
+        for (size_t x = 0; x < 64; x += 5) {
+            EXPECT_DOUBLE_EQ(expected[y * 64 + x], DistanceTransform::get_distance(tree, { x, y }))
+                << x << ", " << y;
+        }
+    }
+}
+
+class DistanceMap : public TestableDistanceTransform { };
+
+TEST_F(DistanceMap, InvalidOrBlankTrees)
+{
+    EXPECT_TRUE(DistanceTransform::compute_distance_map(tree).empty());
+
+    tree.init(QuadTree::Data(8 * 8, C::White));
+    auto distances = DistanceTransform::compute_distance_map(tree);
+    ASSERT_EQ(8 * 8, distances.size());
+    for (auto distance : distances) {
+        EXPECT_EQ(std::numeric_limits<double>::infinity(), distance);
+    }
+}
+
+TEST_F(DistanceMap, MatchesMeasuringPixels)
+{
+    for (size_t side_length : {1, 4, 32, 64}) {
+        auto data = make_drawing(side_length);
+        data[0] = C::Black;
+        tree.init(data);
+
+        auto expected = measure_pixels(data);
+        auto distances = DistanceTransform::compute_distance_map(tree);
+        ASSERT_EQ(expected.size(), distances.size());
+        for (size_t ndx = 0; ndx < expected.size(); ++ndx) {
+            EXPECT_DOUBLE_EQ(expected[ndx], distances[ndx]) << side_length << ": " << ndx;
+        }
+    }
+}
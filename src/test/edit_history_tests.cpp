@@ -0,0 +1,101 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "edit_history.hpp"
+
+using namespace testing;
+using C = QuadNode::ColorValue;
+
+class TestableEditHistory : public Test
+{
+protected:
+    EditHistory sut;
+    QuadTree blank;
+
+    TestableEditHistory()
+    {
+        blank.init(QuadTree::Data(16 * 16, C::White));
+    }
+};
+
+class Initialization : public TestableEditHistory { };
+
+TEST_F(Initialization, Uninitialized_HasInvalidCurrentVersionAndNoHistory)
+{
+    EXPECT_FALSE(sut.get_current().is_valid());
+    EXPECT_FALSE(sut.can_undo());
+    EXPECT_FALSE(sut.can_redo());
+}
+
+TEST_F(Initialization, AfterInitialization_CurrentVersionIsTheGivenTree)
+{
+    sut.init(blank);
+
+    EXPECT_EQ(blank, sut.get_current());
+    EXPECT_FALSE(sut.can_undo());
+}
+
+TEST_F(Initialization, Reinitialization_DiscardsHistory)
+{
+    sut.init(blank);
+    sut.push(blank.with_pixel(0, 0, C::Black));
+    sut.init(blank);
+
+    EXPECT_FALSE(sut.can_undo());
+    EXPECT_FALSE(sut.undo());
+}
+
+class UndoRedo : public TestableEditHistory
+{
+protected:
+    QuadTree first;
+    QuadTree second;
+
+    void SetUp() override
+    {
+        first = blank.with_pixel(1, 2, C::Black);
+        second = first.with_pixel(10, 12, C::Black);
+
+        sut.init(blank);
+        sut.push(first);
+        sut.push(second);
+    }
+};
+
+TEST_F(UndoRedo, UndoWalksBackThroughVersions)
+{
+    EXPECT_EQ(second, sut.get_current());
+
+    EXPECT_TRUE(sut.undo());
+    EXPECT_EQ(first, sut.get_current());
+
+    EXPECT_TRUE(sut.undo());
+    EXPECT_EQ(blank, sut.get_current());
+
+    EXPECT_FALSE(sut.undo());
+    EXPECT_EQ(blank, sut.get_current());
+}
+
+TEST_F(UndoRedo, RedoWalksForwardThroughUndoneVersions)
+{
+    sut.undo();
+    sut.undo();
+
+    EXPECT_TRUE(sut.redo());
+    EXPECT_EQ(first, sut.get_current());
+
+    EXPECT_TRUE(sut.redo());
+    EXPECT_EQ(second, sut.get_current());
+
+    EXPECT_FALSE(sut.redo());
+}
+
+TEST_F(UndoRedo, PushingANewVersion_DiscardsUndoneVersions)
+{
+    sut.undo();
+    sut.push(first.with_pixel(4, 4, C::Black));
+
+    EXPECT_FALSE(sut.can_redo());
+    EXPECT_TRUE(sut.can_undo());
+    EXPECT_EQ(C::Black, sut.get_current().get_pixel(4, 4));
+}
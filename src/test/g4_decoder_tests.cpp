@@ -0,0 +1,95 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "g4_decoder.hpp"
+
+using namespace testing;
+using C = QuadNode::ColorValue;
+using Runs = QuadTree::Runs;
+
+class TestableG4Decoder : public Test
+{
+protected:
+    std::vector<Runs> rows;
+    QuadTree tree;
+};
+
+class Decoding : public TestableG4Decoder { };
+
+TEST_F(Decoding, VerticalModeOnWhiteReference_DecodesWhiteRows)
+{
+    // V0 V0
+    std::vector<uint8_t> data = { 0xc0 };
+
+    ASSERT_TRUE(G4Decoder::decode(data, 8, 2, rows));
+    EXPECT_EQ(std::vector<Runs>(2), rows);
+}
+
+TEST_F(Decoding, AllModes)
+{
+    // H(2 white, 3 black) V0 | V0 V0 V0 | VL1 V0 V0 | P V0 | EOFB
+    std::vector<uint8_t> data = { 0x2f, 0x7a, 0xc6, 0x00, 0x20, 0x02 };
+
+    ASSERT_TRUE(G4Decoder::decode(data, 8, 4, rows));
+    std::vector<Runs> expected = { {2, 5}, {2, 5}, {1, 5}, { } };
+    EXPECT_EQ(expected, rows);
+}
+
+TEST_F(Decoding, LongerVerticalOffsets)
+{
+    // H(4 white, 4 black) V0 | VR3 VR2 V0
+    std::vector<uint8_t> data = { 0x36, 0xe0, 0xc3, 0x80 };
+
+    ASSERT_TRUE(G4Decoder::decode(data, 16, 2, rows));
+    std::vector<Runs> expected = { {4, 8}, {7, 10} };
+    EXPECT_EQ(expected, rows);
+}
+
+TEST_F(Decoding, MakeUpCodes_AddToTerminatingCodes)
+{
+    // H(64 + 6 white, 58 black) | V0 V0
+    std::vector<uint8_t> data = { 0x3b, 0xe0, 0x59, 0xc0 };
+
+    ASSERT_TRUE(G4Decoder::decode(data, 128, 2, rows));
+    std::vector<Runs> expected = { {70}, {70} };
+    EXPECT_EQ(expected, rows);
+}
+
+TEST_F(Decoding, InvalidData_IsRejected)
+{
+    std::vector<uint8_t> truncated = { 0x2f, 0x7a };
+    std::vector<uint8_t> invalid_code = { 0x00, 0x00, 0x00 };
+    std::vector<uint8_t> end_of_block = { 0x00, 0x10, 0x01 };
+    std::vector<uint8_t> run_past_line = { 0x3b, 0xe0, 0x59, 0xc0 };
+
+    EXPECT_FALSE(G4Decoder::decode(truncated, 8, 4, rows));
+    EXPECT_FALSE(G4Decoder::decode(invalid_code, 8, 1, rows));
+    EXPECT_FALSE(G4Decoder::decode(end_of_block, 8, 1, rows));
+    EXPECT_FALSE(G4Decoder::decode(run_past_line, 64, 1, rows));
+}
+
+class Reading : public TestableG4Decoder { };
+
+TEST_F(Reading, BuildsPaddedTreeFromRuns)
+{
+    std::vector<uint8_t> data = { 0x2f, 0x7a, 0xc6, 0x00, 0x20, 0x02 };
+
+    ASSERT_TRUE(G4Decoder::read(data, 6, 4, tree));
+    ASSERT_EQ(8, tree.get_side_length());
+
+    auto pixels = tree.decode();
+    for (size_t y = 0; y < 8; ++y) {
+        for (size_t x = 0; x < 8; ++x) {
+            bool is_black = (y < 2 && x >= 2 && x < 5) || (y == 2 && x >= 1 && x < 5);
+            EXPECT_EQ(is_black ? C::Black : C::White, pixels[y * 8 + x]) << x << ", " << y;
+        }
+    }
+}
+
+TEST_F(Reading, InvalidSize_IsRejected)
+{
+    std::vector<uint8_t> data = { 0xc0 };
+
+    EXPECT_FALSE(G4Decoder::read(data, 0, 2, tree));
+    EXPECT_FALSE(G4Decoder::read(data, 8, 3, tree));
+}
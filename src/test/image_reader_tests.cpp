@@ -0,0 +1,142 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include "image_reader.hpp"
+#include "image_writer.hpp"
+#include "tree_statistics.hpp"
+
+using namespace testing;
+using C = QuadNode::ColorValue;
+
+class TestableImageReader : public Test
+{
+protected:
+    QuadTree tree;
+
+    /** \brief Creates a side_length * side_length image with an asymmetric, noisy pattern. */
+    static QuadTree::Data make_noise(size_t side_length)
+    {
+        QuadTree::Data data;
+        for (size_t y = 0; y < side_length; ++y) {
+            for (size_t x = 0; x < side_length; ++x) {
+                data.push_back((x * x + 3 * y + x * y) % 7 < 3 ? C::Black : C::White);
+            }
+        }
+        return data;
+    }
+};
+
+class Reading : public TestableImageReader { };
+
+TEST_F(Reading, UnknownFormat_IsRejected)
+{
+    std::istringstream in("GIF89a");
+    EXPECT_FALSE(ImageReader::read(in, tree));
+    EXPECT_FALSE(ImageReader::read("no_such_file.bmp", tree));
+}
+
+TEST_F(Reading, TruncatedFile_IsRejected)
+{
+    std::istringstream in(std::string("P4\n16 16\n\xFF\xFF", 11));
+    EXPECT_FALSE(ImageReader::read(in, tree));
+}
+
+TEST_F(Reading, OversizedImages_AreRejectedFromTheirHeader)
+{
+    // neither header is followed by pixels, so only the dimensions can reject them
+    std::istringstream huge("P4\n100000 16\n");
+    EXPECT_FALSE(ImageReader::read(huge, tree));
+
+    std::istringstream overflowing("P4\n16 99999999999999999999999\n");
+    EXPECT_FALSE(ImageReader::read(overflowing, tree));
+}
+
+TEST_F(Reading, RoundTripsWrittenImages)
+{
+    QuadTree expected;
+    expected.init(make_noise(32));
+
+    for (auto format : {ImageWriter::Format::Bmp, ImageWriter::Format::Pbm}) {
+        std::stringstream file;
+        ASSERT_TRUE(ImageWriter(format).write(expected, file));
+
+        file.seekg(0);
+        EXPECT_TRUE(ImageReader::read(file, tree));
+        EXPECT_EQ(expected, tree);
+    }
+}
+
+TEST_F(Reading, PbmHeaderComments)
+{
+    std::istringstream in(std::string("P4 # comment\n# another\n2 2\n\x80\x40", 29));
+
+    ASSERT_TRUE(ImageReader::read(in, tree));
+    QuadTree::Data expected = {
+        C::Black, C::White,
+        C::White, C::Black
+    };
+    EXPECT_EQ(expected, tree.decode());
+}
+
+TEST_F(Reading, NonSquareImages_ArePaddedWithWhite)
+{
+    std::istringstream in(std::string("P4\n3 1\n\xE0", 8));
+
+    ASSERT_TRUE(ImageReader::read(in, tree));
+    QuadTree::Data expected = {
+        C::Black, C::Black, C::Black, C::White,
+        C::White, C::White, C::White, C::White,
+        C::White, C::White, C::White, C::White,
+        C::White, C::White, C::White, C::White
+    };
+    EXPECT_EQ(expected, tree.decode());
+}
+
+TEST_F(Reading, ReadsSampleBitmap)
+{
+    ASSERT_TRUE(ImageReader::read(SOURCE_DIR "/london-skyline.bmp", tree));
+    EXPECT_EQ(256, tree.get_side_length());
+
+    // the sky is white, and the skyline touches the bottom edge
+    EXPECT_EQ(C::White, tree.get_pixel(0, 0));
+    EXPECT_EQ(C::Black, tree.get_pixel(60, 255));
+    EXPECT_LT(0, TreeStatistics::count_black_pixels(tree));
+}
+
+TEST_F(Reading, SampleBitmap_RoundTripsThroughWriter)
+{
+    std::ifstream file(SOURCE_DIR "/london-skyline.bmp", std::ios::in | std::ios::binary);
+    std::string original((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    ASSERT_TRUE(ImageReader::read(SOURCE_DIR "/london-skyline.bmp", tree));
+    std::ostringstream out;
+    ASSERT_TRUE(ImageWriter(ImageWriter::Format::Bmp).write(tree, out));
+    auto written = out.str();
+
+    // the sample records a different resolution and image size, and has 2 bytes of trailing
+    // padding, so compare what describes the pixels: dimensions, depth, palette and scanlines
+    auto le = [](const std::string& bytes, size_t offset) {
+        uint32_t value = 0;
+        for (size_t ndx = 0; ndx < 4; ++ndx) {
+            value |= uint32_t(uint8_t(bytes[offset + ndx])) << (8 * ndx);
+        }
+        return value;
+    };
+    ASSERT_LE(54u + 8, written.size());
+    EXPECT_EQ(le(original, 18), le(written, 18));
+    EXPECT_EQ(le(original, 22), le(written, 22));
+    EXPECT_EQ(original.substr(28, 2), written.substr(28, 2));
+    EXPECT_EQ(original.substr(54, 8), written.substr(54, 8));
+
+    constexpr size_t SCANLINES_SIZE = 256 * 256 / 8;
+    auto original_offset = le(original, 10);
+    auto written_offset = le(written, 10);
+    ASSERT_LE(original_offset + SCANLINES_SIZE, original.size());
+    ASSERT_EQ(written_offset + SCANLINES_SIZE, written.size());
+    EXPECT_TRUE(original.compare(original_offset, SCANLINES_SIZE,
+                                 written, written_offset, SCANLINES_SIZE) == 0);
+}
@@ -0,0 +1,156 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "image_writer.hpp"
+
+using namespace testing;
+using C = QuadNode::ColorValue;
+using Format = ImageWriter::Format;
+
+class TestableImageWriter : public Test
+{
+protected:
+    QuadTree tree;
+
+    /** \brief Creates a side_length * side_length image with an asymmetric, noisy pattern. */
+    static QuadTree::Data make_noise(size_t side_length)
+    {
+        QuadTree::Data data;
+        for (size_t y = 0; y < side_length; ++y) {
+            for (size_t x = 0; x < side_length; ++x) {
+                data.push_back((x * x + 3 * y + x * y) % 7 < 3 ? C::Black : C::White);
+            }
+        }
+        return data;
+    }
+
+    /** \brief Packs a row of pixel data MSB first, set bits black, padded to stride bytes. */
+    static std::string pack_row(const QuadTree::Data& data, size_t row, size_t side_length,
+                                size_t stride)
+    {
+        std::string packed(stride, '\0');
+        for (size_t x = 0; x < side_length; ++x) {
+            if (data[row * side_length + x] == C::Black) {
+                packed[x / 8] |= char(0x80 >> (x % 8));
+            }
+        }
+        return packed;
+    }
+
+    static std::string write(const QuadTree& tree, Format format, size_t band_height)
+    {
+        std::ostringstream out;
+        EXPECT_TRUE(ImageWriter(format, band_height).write(tree, out));
+        return out.str();
+    }
+
+    static uint32_t read_le(const std::string& bytes, size_t offset, size_t width)
+    {
+        uint32_t value = 0;
+        for (size_t ndx = 0; ndx < width; ++ndx) {
+            value |= uint32_t(uint8_t(bytes[offset + ndx])) << (8 * ndx);
+        }
+        return value;
+    }
+};
+
+class Formats : public TestableImageWriter { };
+
+TEST_F(Formats, FormatFromFileName)
+{
+    Format format;
+
+    EXPECT_TRUE(ImageWriter::format_from_file_name("out.bmp", format));
+    EXPECT_EQ(Format::Bmp, format);
+
+    EXPECT_TRUE(ImageWriter::format_from_file_name("dir/out.pbm", format));
+    EXPECT_EQ(Format::Pbm, format);
+
+    EXPECT_FALSE(ImageWriter::format_from_file_name("out.png", format));
+    EXPECT_FALSE(ImageWriter::format_from_file_name(".bmp", format));
+}
+
+TEST_F(Formats, InvalidTree_IsNotWritten)
+{
+    std::ostringstream out;
+    EXPECT_FALSE(ImageWriter(Format::Pbm).write(tree, out));
+    EXPECT_TRUE(out.str().empty());
+}
+
+class WritingPbm : public TestableImageWriter { };
+
+TEST_F(WritingPbm, WritesHeaderAndScanlinesTopToBottom)
+{
+    auto data = make_noise(16);
+    tree.init(data);
+
+    std::string expected = "P4\n16 16\n";
+    for (size_t row = 0; row < 16; ++row) {
+        expected += pack_row(data, row, 16, 2);
+    }
+
+    EXPECT_EQ(expected, write(tree, Format::Pbm, 5));
+}
+
+TEST_F(WritingPbm, ScanlinesNarrowerThanAByteArePadded)
+{
+    tree.init({
+        C::Black, C::White,
+        C::White, C::Black
+    });
+
+    EXPECT_EQ(std::string("P4\n2 2\n\x80\x40", 9), write(tree, Format::Pbm, 1));
+}
+
+TEST_F(WritingPbm, BandHeightDoesNotChangeOutput)
+{
+    tree.init(make_noise(64));
+
+    auto expected = write(tree, Format::Pbm, 64);
+    EXPECT_EQ(expected, write(tree, Format::Pbm, 1));
+    EXPECT_EQ(expected, write(tree, Format::Pbm, 7));
+    EXPECT_EQ(expected, write(tree, Format::Pbm, 1000));
+}
+
+class WritingBmp : public TestableImageWriter { };
+
+TEST_F(WritingBmp, WritesHeaders)
+{
+    tree.init(make_noise(16));
+    auto bytes = write(tree, Format::Bmp, 4);
+
+    ASSERT_EQ(62 + 16 * 4, bytes.size());
+    EXPECT_EQ("BM", bytes.substr(0, 2));
+    EXPECT_EQ(bytes.size(), read_le(bytes, 2, 4));
+    EXPECT_EQ(62, read_le(bytes, 10, 4));
+    EXPECT_EQ(40, read_le(bytes, 14, 4));
+    EXPECT_EQ(16, read_le(bytes, 18, 4));
+    EXPECT_EQ(16, read_le(bytes, 22, 4));
+    EXPECT_EQ(1, read_le(bytes, 28, 2));
+    EXPECT_EQ(0xFFFFFF, read_le(bytes, 54, 4));
+    EXPECT_EQ(0x000000, read_le(bytes, 58, 4));
+}
+
+TEST_F(WritingBmp, WritesPaddedScanlinesBottomToTop)
+{
+    auto data = make_noise(64);
+    tree.init(data);
+
+    std::string expected;
+    for (size_t row = 64; row-- > 0;) {
+        expected += pack_row(data, row, 64, 8);
+    }
+
+    EXPECT_EQ(expected, write(tree, Format::Bmp, 10).substr(62));
+}
+
+TEST_F(WritingBmp, BandHeightDoesNotChangeOutput)
+{
+    tree.init(make_noise(32));
+
+    auto expected = write(tree, Format::Bmp, 32);
+    EXPECT_EQ(expected, write(tree, Format::Bmp, 1));
+    EXPECT_EQ(expected, write(tree, Format::Bmp, 3));
+}
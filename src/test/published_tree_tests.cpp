@@ -0,0 +1,171 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "published_tree.hpp"
+
+using namespace testing;
+using C = QuadNode::ColorValue;
+
+class TestablePublishedTree : public Test
+{
+protected:
+    /** \brief Creates a blank image with a black pixel in each of its first count pixels. */
+    static QuadTree make_tree(size_t count, size_t side_length = 64)
+    {
+        QuadTree::Data data(side_length * side_length, C::White);
+        std::fill(data.begin(), data.begin() + count, C::Black);
+
+        QuadTree tree;
+        tree.init(data);
+        return tree;
+    }
+};
+
+class Publishing : public TestablePublishedTree { };
+
+TEST_F(Publishing, OnConstruction_TreeIsInvalid)
+{
+    PublishedTree sut;
+
+    EXPECT_FALSE(sut.get_snapshot().is_valid());
+    EXPECT_FALSE(sut.read().get_tree().is_valid());
+}
+
+TEST_F(Publishing, SnapshotsSeeThePublishedTree)
+{
+    PublishedTree sut;
+    sut.publish(make_tree(1));
+    EXPECT_EQ(make_tree(1), sut.get_snapshot());
+
+    sut.publish(make_tree(2));
+    EXPECT_EQ(make_tree(2), sut.get_snapshot());
+    EXPECT_EQ(0, sut.get_retired_count());
+}
+
+TEST_F(Publishing, PinnedVersions_OutliveTheirReplacement)
+{
+    PublishedTree sut;
+    sut.publish(make_tree(1));
+
+    {
+        auto guard = sut.read();
+        sut.publish(make_tree(2));
+        sut.publish(make_tree(3));
+
+        EXPECT_EQ(make_tree(1), guard.get_tree());
+        EXPECT_EQ(make_tree(3), sut.read().get_tree());
+        EXPECT_EQ(2, sut.get_retired_count());
+    }
+
+    sut.reclaim();
+    EXPECT_EQ(0, sut.get_retired_count());
+}
+
+TEST_F(Publishing, ReadersBeyondTheSlots_UseOverflowSlots)
+{
+    PublishedTree sut(1);
+    sut.publish(make_tree(1));
+
+    {
+        // every guard holds a slot, so without overflow slots the second read would never return
+        auto first = sut.read();
+        auto second = sut.read();
+        sut.publish(make_tree(2));
+        auto third = sut.read();
+
+        EXPECT_EQ(make_tree(1), first.get_tree());
+        EXPECT_EQ(make_tree(1), second.get_tree());
+        EXPECT_EQ(make_tree(2), third.get_tree());
+        EXPECT_EQ(1, sut.get_retired_count());
+    }
+
+    sut.reclaim();
+    EXPECT_EQ(0, sut.get_retired_count());
+
+    // released overflow slots are reused, and still keep the versions they pin alive
+    {
+        auto first = sut.read();
+        auto second = sut.read();
+        sut.publish(make_tree(3));
+        sut.reclaim();
+        EXPECT_EQ(make_tree(2), second.get_tree());
+        EXPECT_EQ(1, sut.get_retired_count());
+    }
+}
+
+TEST_F(Publishing, Snapshots_OutliveReclamation)
+{
+    PublishedTree sut;
+    sut.publish(make_tree(5));
+    auto snapshot = sut.get_snapshot();
+
+    sut.publish(make_tree(6));
+    EXPECT_EQ(0, sut.get_retired_count());
+    EXPECT_EQ(make_tree(5), snapshot);
+}
+
+TEST_F(Publishing, Update_EditsTheCurrentVersion)
+{
+    PublishedTree sut;
+    sut.publish(make_tree(0));
+
+    EXPECT_TRUE(sut.update([](const QuadTree& tree) { return tree.with_pixel(0, 0, C::Black); }));
+    EXPECT_EQ(make_tree(1), sut.get_snapshot());
+
+    EXPECT_FALSE(sut.update([](const QuadTree&) { return QuadTree(); }));
+    EXPECT_EQ(make_tree(1), sut.get_snapshot());
+}
+
+class Concurrency : public TestablePublishedTree { };
+
+TEST_F(Concurrency, ReadersSeeEveryVersionInOrder)
+{
+    constexpr size_t EDITS = 500;
+    constexpr size_t READERS = 6;
+
+    // fewer slots than readers, so some readers pin versions from overflow slots
+    PublishedTree sut(4);
+    sut.publish(make_tree(0));
+
+    std::atomic<bool> done(false);
+    std::atomic<size_t> failures(0);
+    std::vector<std::thread> readers;
+    for (size_t reader = 0; reader < READERS; ++reader) {
+        readers.emplace_back([&] {
+            size_t last = 0;
+            while (!done.load()) {
+                auto guard = sut.read();
+                const auto& tree = guard.get_tree();
+                auto black_pixels = tree.get_root()->get_black_pixels();
+                if (!tree.is_valid() || black_pixels < last) {
+                    ++failures;
+                }
+                last = black_pixels;
+            }
+        });
+    }
+
+    std::thread writer([&] {
+        for (size_t edit = 0; edit < EDITS; ++edit) {
+            sut.update([edit](const QuadTree& tree) {
+                return tree.with_pixel(edit % 64, edit / 64, C::Black);
+            });
+        }
+        done = true;
+    });
+
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(0, failures.load());
+    EXPECT_EQ(make_tree(EDITS), sut.get_snapshot());
+
+    sut.reclaim();
+    EXPECT_EQ(0, sut.get_retired_count());
+}
@@ -137,3 +137,171 @@ protected:
         sut.set_children(std::move(children));
     }
 };
+
+class Blocks : public TestableQuadNode { };
+
+TEST_F(Blocks, RegularNodesAreNotBlocks)
+{
+    sut.init(QuadNode::BLOCK_SIDE_LENGTH, ColorValue::Black);
+
+    EXPECT_FALSE(sut.is_block());
+    EXPECT_EQ(0, sut.get_block());
+}
+
+TEST_F(Blocks, BlockNodeIsAValidMixedLeaf)
+{
+    QuadNode block(0x8001);
+
+    EXPECT_TRUE(block.is_valid());
+    EXPECT_TRUE(block.is_leaf());
+    EXPECT_TRUE(block.is_block());
+    EXPECT_EQ(0x8001, block.get_block());
+    EXPECT_EQ(QuadNode::BLOCK_SIDE_LENGTH, block.get_side_length());
+    EXPECT_EQ(ColorValue::Mixed, block.get_color_value());
+}
+
+TEST_F(Blocks, BlocksNeverHaveChildren)
+{
+    QuadNode block(0x8001);
+    QuadNode::Quad<std::unique_ptr<QuadNode>> children = {
+        std::unique_ptr<QuadNode>(new QuadNode(4, ColorValue::Black)),
+        std::unique_ptr<QuadNode>(new QuadNode(4, ColorValue::Black)),
+        std::unique_ptr<QuadNode>(new QuadNode(4, ColorValue::Black)),
+        std::unique_ptr<QuadNode>(new QuadNode(4, ColorValue::Black))
+    };
+
+    EXPECT_FALSE(block.set_children(std::move(children)));
+    EXPECT_TRUE(block.is_leaf());
+}
+
+TEST_F(Blocks, BlocksAreEqualIffTheirPixelsAre)
+{
+    EXPECT_EQ(QuadNode(0x8001), QuadNode(0x8001));
+    EXPECT_NE(QuadNode(0x8001), QuadNode(0x8002));
+    EXPECT_NE(QuadNode(0x8001), QuadNode(QuadNode::BLOCK_SIDE_LENGTH, ColorValue::Mixed));
+}
+
+class BlackPixels : public TestableQuadNode { };
+
+TEST_F(BlackPixels, LeavesCountTheirWholeAreaOrBits)
+{
+    EXPECT_EQ(0, sut.get_black_pixels());
+    EXPECT_EQ(16, QuadNode(4, ColorValue::Black).get_black_pixels());
+    EXPECT_EQ(0, QuadNode(4, ColorValue::White).get_black_pixels());
+    EXPECT_EQ(3, QuadNode(0x8000000000008001).get_black_pixels());
+}
+
+TEST_F(BlackPixels, ParentsSumTheirChildren)
+{
+    QuadNode::Quad<std::unique_ptr<QuadNode>> children = {
+        std::unique_ptr<QuadNode>(new QuadNode(0x8001)),
+        std::unique_ptr<QuadNode>(new QuadNode(8, ColorValue::Black)),
+        std::unique_ptr<QuadNode>(new QuadNode(8, ColorValue::White)),
+        std::unique_ptr<QuadNode>(new QuadNode(0xff))
+    };
+    sut.init(16, ColorValue::Mixed);
+
+    ASSERT_TRUE(sut.set_children(std::move(children)));
+    EXPECT_EQ(2 + 64 + 8, sut.get_black_pixels());
+}
+
+class Hashing : public TestableQuadNode { };
+
+TEST_F(Hashing, EqualNodesHaveEqualHashes)
+{
+    EXPECT_EQ(QuadNode(4, ColorValue::Black).get_hash(), QuadNode(4, ColorValue::Black).get_hash());
+    EXPECT_EQ(QuadNode(0x8001).get_hash(), QuadNode(0x8001).get_hash());
+
+    EXPECT_NE(QuadNode(4, ColorValue::Black).get_hash(), QuadNode(4, ColorValue::White).get_hash());
+    EXPECT_NE(QuadNode(4, ColorValue::Black).get_hash(), QuadNode(8, ColorValue::Black).get_hash());
+    EXPECT_NE(QuadNode(0x8001).get_hash(), QuadNode(0x8002).get_hash());
+}
+
+TEST_F(Hashing, ParentsHashTheirChildrenInOrder)
+{
+    auto make_children = [](ColorValue first, ColorValue second) {
+        return QuadNode::Quad<std::unique_ptr<QuadNode>> {
+            std::unique_ptr<QuadNode>(new QuadNode(2, first)),
+            std::unique_ptr<QuadNode>(new QuadNode(2, second)),
+            std::unique_ptr<QuadNode>(new QuadNode(2, ColorValue::White)),
+            std::unique_ptr<QuadNode>(new QuadNode(2, ColorValue::White))
+        };
+    };
+
+    QuadNode one(4, ColorValue::Mixed);
+    QuadNode same(4, ColorValue::Mixed);
+    QuadNode swapped(4, ColorValue::Mixed);
+    auto leaf_hash = one.get_hash();
+
+    ASSERT_TRUE(one.set_children(make_children(ColorValue::Black, ColorValue::White)));
+    ASSERT_TRUE(same.set_children(make_children(ColorValue::Black, ColorValue::White)));
+    ASSERT_TRUE(swapped.set_children(make_children(ColorValue::White, ColorValue::Black)));
+
+    EXPECT_EQ(one.get_hash(), same.get_hash());
+    EXPECT_NE(one.get_hash(), swapped.get_hash());
+    EXPECT_NE(leaf_hash, one.get_hash());
+}
+
+class Aggregates : public TestableQuadNode { };
+
+TEST_F(Aggregates, LeavesCoverTheirOwnPixels)
+{
+    QuadNode black(4, ColorValue::Black);
+    QuadNode block(0x0000000000300400);
+
+    EXPECT_EQ(4, black.get_black_bounds().width);
+    EXPECT_EQ(0, QuadNode(4, ColorValue::White).get_black_bounds().width);
+    EXPECT_EQ(1, block.get_node_count());
+    EXPECT_EQ(0, block.get_depth());
+
+    // bits 10, 20 and 21 are pixels (2, 1), (4, 2) and (5, 2)
+    auto bounds = block.get_black_bounds();
+    EXPECT_EQ(2, bounds.x);
+    EXPECT_EQ(1, bounds.y);
+    EXPECT_EQ(4, bounds.width);
+    EXPECT_EQ(2, bounds.height);
+}
+
+TEST_F(Aggregates, ParentsCombineTheirChildren)
+{
+    auto deep = std::unique_ptr<QuadNode>(new QuadNode(8, ColorValue::Mixed));
+    ASSERT_TRUE(deep->set_children(QuadNode::Quad<std::unique_ptr<QuadNode>> {
+        std::unique_ptr<QuadNode>(new QuadNode(4, ColorValue::White)),
+        std::unique_ptr<QuadNode>(new QuadNode(4, ColorValue::White)),
+        std::unique_ptr<QuadNode>(new QuadNode(4, ColorValue::Black)),
+        std::unique_ptr<QuadNode>(new QuadNode(4, ColorValue::White))
+    }));
+
+    sut.init(16, ColorValue::Mixed);
+    ASSERT_TRUE(sut.set_children(QuadNode::Quad<std::unique_ptr<QuadNode>> {
+        std::unique_ptr<QuadNode>(new QuadNode(0x8000)),
+        std::move(deep),
+        std::unique_ptr<QuadNode>(new QuadNode(8, ColorValue::White)),
+        std::unique_ptr<QuadNode>(new QuadNode(8, ColorValue::White))
+    }));
+
+    EXPECT_EQ(9, sut.get_node_count());
+    EXPECT_EQ(2, sut.get_depth());
+    EXPECT_TRUE(sut.is_subtree_valid());
+
+    // the deep q3 spans (0, 4) to (3, 7), the block's bit 15 is pixel (15, 1)
+    auto bounds = sut.get_black_bounds();
+    EXPECT_EQ(0, bounds.x);
+    EXPECT_EQ(1, bounds.y);
+    EXPECT_EQ(16, bounds.width);
+    EXPECT_EQ(7, bounds.height);
+}
+
+TEST_F(Aggregates, UninitializedDescendants_InvalidateTheSubtree)
+{
+    sut.init(2, ColorValue::Mixed);
+    ASSERT_TRUE(sut.set_children(QuadNode::Quad<std::unique_ptr<QuadNode>> {
+        std::unique_ptr<QuadNode>(new QuadNode(1, ColorValue::White)),
+        std::unique_ptr<QuadNode>(new QuadNode()),
+        std::unique_ptr<QuadNode>(new QuadNode(1, ColorValue::White)),
+        std::unique_ptr<QuadNode>(new QuadNode(1, ColorValue::White))
+    }));
+
+    EXPECT_TRUE(sut.is_valid());
+    EXPECT_FALSE(sut.is_subtree_valid());
+}
@@ -12,6 +12,7 @@ protected:
     QuadTree sut;
 
     QuadTree tree_from_root(std::shared_ptr<QuadNode> root) { return QuadTree(root); }
+    std::shared_ptr<QuadNode> root_of(const QuadTree& tree) { return tree.root_; }
 };
 
 class Initialization : public TestableQuadTree { };
@@ -202,3 +203,1015 @@ TEST_F(Comparison, GivenTwo4x4Trees)
 
     EXPECT_EQ(one, other);
 }
+
+class Decoding : public TestableQuadTree { };
+
+TEST_F(Decoding, InvalidTree_DecodesToEmptyData)
+{
+    EXPECT_TRUE(sut.decode().empty());
+    EXPECT_EQ(0, sut.get_side_length());
+}
+
+TEST_F(Decoding, DecodedDataMatchesInitializationData)
+{
+    QuadTree::Data data = {
+        C::White, C::White, C::Black, C::White,
+        C::White, C::White, C::White, C::Black,
+        C::Black, C::Black, C::Black, C::Black,
+        C::White, C::White, C::Black, C::Black
+    };
+    sut.init(data);
+
+    EXPECT_EQ(4, sut.get_side_length());
+    EXPECT_EQ(data, sut.decode());
+}
+
+class Rotation : public TestableQuadTree
+{
+protected:
+    QuadTree::Data data = {
+        C::Black, C::White, C::White, C::White,
+        C::Black, C::Black, C::White, C::White,
+        C::White, C::White, C::White, C::Black,
+        C::White, C::White, C::Black, C::Black
+    };
+
+    void SetUp() override { sut.init(data); }
+};
+
+TEST_F(Rotation, InvalidTree_RotatesToInvalidTree)
+{
+    QuadTree invalid;
+    EXPECT_FALSE(invalid.rotate(QuadTree::Rotation::Clockwise90).is_valid());
+}
+
+TEST_F(Rotation, NoRotation_IsEqualToOriginal)
+{
+    EXPECT_EQ(sut, sut.rotate(QuadTree::Rotation::None));
+}
+
+TEST_F(Rotation, Clockwise90)
+{
+    QuadTree::Data expected = {
+        C::White, C::White, C::Black, C::Black,
+        C::White, C::White, C::Black, C::White,
+        C::Black, C::White, C::White, C::White,
+        C::Black, C::Black, C::White, C::White
+    };
+
+    EXPECT_EQ(expected, sut.rotate(QuadTree::Rotation::Clockwise90).decode());
+}
+
+TEST_F(Rotation, Clockwise180)
+{
+    QuadTree::Data expected = {
+        C::Black, C::Black, C::White, C::White,
+        C::Black, C::White, C::White, C::White,
+        C::White, C::White, C::Black, C::Black,
+        C::White, C::White, C::White, C::Black
+    };
+
+    EXPECT_EQ(expected, sut.rotate(QuadTree::Rotation::Clockwise180).decode());
+}
+
+TEST_F(Rotation, FourQuarterTurns_IsEqualToOriginal)
+{
+    auto rotated = sut;
+    for (int turn = 0; turn < 4; ++turn) {
+        rotated = rotated.rotate(QuadTree::Rotation::Clockwise90);
+    }
+
+    EXPECT_EQ(sut, rotated);
+    EXPECT_EQ(sut.rotate(QuadTree::Rotation::Clockwise270),
+              sut.rotate(QuadTree::Rotation::Clockwise180).rotate(QuadTree::Rotation::Clockwise90));
+}
+
+class Blocks : public TestableQuadTree
+{
+protected:
+    /** \brief Creates a side_length * side_length image with an asymmetric, noisy pattern. */
+    static QuadTree::Data make_noise(size_t side_length)
+    {
+        QuadTree::Data data;
+        for (size_t y = 0; y < side_length; ++y) {
+            for (size_t x = 0; x < side_length; ++x) {
+                data.push_back((x * x + 3 * y + x * y) % 7 < 3 ? C::Black : C::White);
+            }
+        }
+        return data;
+    }
+
+    /** \brief Rotates square pixel data a quarter turn clockwise, one pixel at a time. */
+    static QuadTree::Data rotate_pixels(const QuadTree::Data& data)
+    {
+        size_t side_length = sqrt(data.size());
+        QuadTree::Data rotated(data.size());
+        for (size_t y = 0; y < side_length; ++y) {
+            for (size_t x = 0; x < side_length; ++x) {
+                rotated[x * side_length + (side_length - 1 - y)] = data[y * side_length + x];
+            }
+        }
+        return rotated;
+    }
+
+    /** \brief Mirrors square pixel data left to right, one pixel at a time. */
+    static QuadTree::Data flip_pixels(const QuadTree::Data& data)
+    {
+        size_t side_length = sqrt(data.size());
+        QuadTree::Data flipped(data.size());
+        for (size_t y = 0; y < side_length; ++y) {
+            for (size_t x = 0; x < side_length; ++x) {
+                flipped[y * side_length + (side_length - 1 - x)] = data[y * side_length + x];
+            }
+        }
+        return flipped;
+    }
+};
+
+TEST_F(Blocks, Given8x8HeterogeneousImage_CreatesSingleBlock)
+{
+    auto data = make_noise(8);
+    sut.init(data);
+    EXPECT_TRUE(sut.is_valid());
+
+    QuadNode::Block block = 0;
+    for (size_t ndx = 0; ndx < data.size(); ++ndx) {
+        if (data[ndx] == C::Black) {
+            block |= QuadNode::Block(1) << ndx;
+        }
+    }
+
+    auto expected = tree_from_root(std::make_shared<QuadNode>(block));
+    EXPECT_EQ(expected, sut);
+    EXPECT_EQ(data, sut.decode());
+}
+
+TEST_F(Blocks, Given8x8HomogenousImage_CreatesRegularLeaf)
+{
+    sut.init(QuadTree::Data(64, C::Black));
+
+    auto expected = tree_from_root(std::make_shared<QuadNode>(8, C::Black));
+    EXPECT_EQ(expected, sut);
+}
+
+TEST_F(Blocks, RotatingBlocks_MatchesRotatingPixels)
+{
+    auto data = make_noise(32);
+    sut.init(data);
+
+    auto quarter = rotate_pixels(data);
+    auto half = rotate_pixels(quarter);
+    auto three_quarter = rotate_pixels(half);
+
+    EXPECT_EQ(quarter, sut.rotate(QuadTree::Rotation::Clockwise90).decode());
+    EXPECT_EQ(half, sut.rotate(QuadTree::Rotation::Clockwise180).decode());
+    EXPECT_EQ(three_quarter, sut.rotate(QuadTree::Rotation::Clockwise270).decode());
+}
+
+TEST_F(Blocks, FlippingBlocks_MatchesFlippingPixels)
+{
+    auto data = make_noise(32);
+    sut.init(data);
+
+    auto horizontal = flip_pixels(data);
+    auto vertical = rotate_pixels(rotate_pixels(horizontal));
+
+    EXPECT_EQ(horizontal, sut.flip(QuadTree::Flip::Horizontal).decode());
+    EXPECT_EQ(vertical, sut.flip(QuadTree::Flip::Vertical).decode());
+    EXPECT_EQ(sut, sut.flip(QuadTree::Flip::Vertical).flip(QuadTree::Flip::Vertical));
+}
+
+class Editing : public TestableQuadTree
+{
+protected:
+    static constexpr size_t SIDE_LENGTH = 32;
+
+    void SetUp() override { sut.init(QuadTree::Data(SIDE_LENGTH * SIDE_LENGTH, C::White)); }
+};
+constexpr size_t Editing::SIDE_LENGTH;
+
+TEST_F(Editing, GetPixel_OutOfBoundsOrInvalid_IsMixed)
+{
+    EXPECT_EQ(C::White, sut.get_pixel(SIDE_LENGTH - 1, SIDE_LENGTH - 1));
+    EXPECT_EQ(C::Mixed, sut.get_pixel(SIDE_LENGTH, 0));
+    EXPECT_EQ(C::Mixed, QuadTree().get_pixel(0, 0));
+}
+
+TEST_F(Editing, WithPixel_RejectsInvalidEdits)
+{
+    EXPECT_FALSE(sut.with_pixel(SIDE_LENGTH, 0, C::Black).is_valid());
+    EXPECT_FALSE(sut.with_pixel(0, 0, C::Mixed).is_valid());
+    EXPECT_FALSE(QuadTree().with_pixel(0, 0, C::Black).is_valid());
+}
+
+TEST_F(Editing, WithPixel_LeavesOriginalUntouched)
+{
+    auto original = sut.decode();
+    auto edited = sut.with_pixel(3, 17, C::Black);
+
+    EXPECT_EQ(original, sut.decode());
+    EXPECT_EQ(C::White, sut.get_pixel(3, 17));
+    EXPECT_EQ(C::Black, edited.get_pixel(3, 17));
+}
+
+TEST_F(Editing, WithPixel_IsEqualToTreeInitializedFromEditedImage)
+{
+    auto data = sut.decode();
+    auto edited = sut;
+
+    for (size_t ndx = 0; ndx < data.size(); ndx += 37) {
+        data[ndx] = C::Black;
+        edited = edited.with_pixel(ndx % SIDE_LENGTH, ndx / SIDE_LENGTH, C::Black);
+    }
+
+    QuadTree expected;
+    expected.init(data);
+    EXPECT_EQ(expected, edited);
+    EXPECT_EQ(data, edited.decode());
+}
+
+TEST_F(Editing, WithPixel_MergesHomogenousQuadrantsBackIntoLeaves)
+{
+    auto edited = sut.with_pixel(5, 5, C::Black).with_pixel(20, 9, C::Black);
+    edited = edited.with_pixel(5, 5, C::White).with_pixel(20, 9, C::White);
+
+    EXPECT_EQ(sut, edited);
+    EXPECT_TRUE(root_of(edited)->is_leaf());
+}
+
+TEST_F(Editing, WithPixel_SharesUntouchedSubtrees)
+{
+    auto one = sut.with_pixel(0, 0, C::Black);
+    auto other = one.with_pixel(SIDE_LENGTH - 1, SIDE_LENGTH - 1, C::Black);
+
+    // the edit only touched the south-east quadrant, the rest is shared
+    auto one_children = root_of(one)->get_children();
+    auto other_children = root_of(other)->get_children();
+    EXPECT_EQ(one_children.q1, other_children.q1);
+    EXPECT_EQ(one_children.q2, other_children.q2);
+    EXPECT_EQ(one_children.q3, other_children.q3);
+    EXPECT_NE(one_children.q4, other_children.q4);
+}
+
+TEST_F(Editing, WithPixel_UnchangedPixelReturnsSameTree)
+{
+    auto edited = sut.with_pixel(1, 1, C::White);
+    EXPECT_EQ(root_of(sut), root_of(edited));
+}
+
+TEST_F(Editing, Transforms_ShareHomogenousLeaves)
+{
+    auto edited = sut.with_pixel(0, 0, C::Black);
+    auto rotated = edited.rotate(QuadTree::Rotation::Clockwise90);
+
+    // the untouched north-east quadrant moves to the south-east
+    EXPECT_EQ(root_of(edited)->get_children().q1, root_of(rotated)->get_children().q4);
+}
+
+class Resampling : public Blocks
+{
+protected:
+    /** \brief Rotates square pixel data about its center, sampling one pixel at a time. */
+    static QuadTree::Data rotate_pixels_by(const QuadTree::Data& data, double degrees)
+    {
+        size_t side_length = sqrt(data.size());
+        double center = side_length / 2.0;
+        double radians = degrees * M_PI / 180;
+
+        QuadTree::Data rotated(data.size(), C::White);
+        for (size_t y = 0; y < side_length; ++y) {
+            for (size_t x = 0; x < side_length; ++x) {
+                double dx = x + 0.5 - center;
+                double dy = y + 0.5 - center;
+                double source_x = floor(cos(radians) * dx + sin(radians) * dy + center);
+                double source_y = floor(-sin(radians) * dx + cos(radians) * dy + center);
+
+                if (source_x >= 0 && source_y >= 0 &&
+                    source_x < side_length && source_y < side_length) {
+                    rotated[y * side_length + x] = data[source_y * side_length + source_x];
+                }
+            }
+        }
+        return rotated;
+    }
+};
+
+TEST_F(Resampling, InvalidTreeOrScale_IsInvalid)
+{
+    EXPECT_FALSE(sut.rotate_by(10).is_valid());
+    EXPECT_FALSE(sut.scale(2).is_valid());
+
+    sut.init(make_noise(8));
+    EXPECT_FALSE(sut.scale(0).is_valid());
+    EXPECT_FALSE(sut.scale(-1).is_valid());
+}
+
+TEST_F(Resampling, RegionColor)
+{
+    sut.init({
+        C::Black, C::Black, C::White, C::White,
+        C::Black, C::Black, C::Black, C::White,
+        C::White, C::White, C::White, C::White,
+        C::White, C::White, C::White, C::White
+    });
+
+    EXPECT_EQ(C::Black, sut.get_region_color({0, 0, 2, 2}));
+    EXPECT_EQ(C::Black, sut.get_region_color({1, 1, 2, 1}));
+    EXPECT_EQ(C::White, sut.get_region_color({0, 2, 4, 2}));
+    EXPECT_EQ(C::White, sut.get_region_color({3, 0, 10, 10}));
+    EXPECT_EQ(C::Mixed, sut.get_region_color({0, 0, 4, 4}));
+    EXPECT_EQ(C::Mixed, sut.get_region_color({4, 4, 2, 2}));
+}
+
+TEST_F(Resampling, RightAngles_MatchQuarterTurns)
+{
+    sut.init(make_noise(32));
+
+    EXPECT_EQ(sut, sut.rotate_by(0));
+    EXPECT_EQ(sut.rotate(QuadTree::Rotation::Clockwise90), sut.rotate_by(90));
+    EXPECT_EQ(sut.rotate(QuadTree::Rotation::Clockwise180), sut.rotate_by(180));
+    EXPECT_EQ(sut.rotate(QuadTree::Rotation::Clockwise270), sut.rotate_by(-90));
+}
+
+TEST_F(Resampling, ArbitraryAngles_MatchRotatingPixels)
+{
+    auto data = make_noise(32);
+    sut.init(data);
+
+    for (auto degrees : {1.7, 30.0, 37.0, -12.5}) {
+        auto rotated = sut.rotate_by(degrees);
+        EXPECT_EQ(rotate_pixels_by(data, degrees), rotated.decode()) << degrees << " degrees";
+
+        QuadTree expected;
+        expected.init(rotated.decode());
+        EXPECT_EQ(expected, rotated) << degrees << " degrees";
+    }
+}
+
+TEST_F(Resampling, HomogenousImage_RotatesToSingleLeaf)
+{
+    sut.init(QuadTree::Data(64 * 64, C::White));
+    EXPECT_EQ(sut, sut.rotate_by(1.7));
+
+    sut.init(QuadTree::Data(64 * 64, C::Black));
+    auto rotated = sut.rotate_by(45);
+    EXPECT_EQ(C::White, rotated.get_pixel(0, 0));
+    EXPECT_EQ(C::Black, rotated.get_pixel(32, 32));
+}
+
+TEST_F(Resampling, ScalingUp_RepeatsPixels)
+{
+    sut.init({
+        C::Black, C::White,
+        C::White, C::White
+    });
+
+    auto scaled = sut.scale(2);
+    QuadTree::Data expected = {
+        C::Black, C::Black, C::White, C::White,
+        C::Black, C::Black, C::White, C::White,
+        C::White, C::White, C::White, C::White,
+        C::White, C::White, C::White, C::White
+    };
+    EXPECT_EQ(expected, scaled.decode());
+}
+
+TEST_F(Resampling, ScalingByNonPowerOfTwo_PadsToPowerOfTwo)
+{
+    auto data = make_noise(16);
+    sut.init(data);
+
+    auto scaled = sut.scale(1.5);
+    ASSERT_EQ(32, scaled.get_side_length());
+
+    for (size_t y = 0; y < 32; ++y) {
+        for (size_t x = 0; x < 32; ++x) {
+            auto expected = C::White;
+            if (x < 24 && y < 24) {
+                expected = data[size_t((y + 0.5) / 1.5) * 16 + size_t((x + 0.5) / 1.5)];
+            }
+            EXPECT_EQ(expected, scaled.get_pixel(x, y)) << x << ", " << y;
+        }
+    }
+}
+
+TEST_F(Resampling, ScalingDown)
+{
+    sut.init(make_noise(32));
+    auto scaled = sut.scale(0.25);
+
+    ASSERT_EQ(8, scaled.get_side_length());
+    for (size_t y = 0; y < 8; ++y) {
+        for (size_t x = 0; x < 8; ++x) {
+            EXPECT_EQ(sut.get_pixel(x * 4 + 2, y * 4 + 2), scaled.get_pixel(x, y));
+        }
+    }
+}
+
+class Packing : public Blocks { };
+
+TEST_F(Packing, RejectsInvalidBands)
+{
+    std::vector<uint8_t> band;
+    EXPECT_FALSE(sut.pack_rows(0, 1, 1, band));
+
+    sut.init(make_noise(16));
+    EXPECT_FALSE(sut.pack_rows(10, 7, 2, band));
+    EXPECT_FALSE(sut.pack_rows(0, 1, 1, band));
+    EXPECT_TRUE(sut.pack_rows(16, 0, 2, band));
+    EXPECT_TRUE(band.empty());
+}
+
+TEST_F(Packing, PacksBlocksAndLeavesMostSignificantBitFirst)
+{
+    auto data = make_noise(32);
+    data[0] = C::Black;
+    for (size_t ndx = 16 * 32; ndx < data.size(); ++ndx) {
+        data[ndx] = C::Black;
+    }
+    sut.init(data);
+
+    std::vector<uint8_t> band;
+    ASSERT_TRUE(sut.pack_rows(3, 20, 5, band));
+    ASSERT_EQ(20 * 5, band.size());
+
+    for (size_t row = 0; row < 20; ++row) {
+        for (size_t x = 0; x < 32; ++x) {
+            bool is_black = band[row * 5 + x / 8] & (0x80 >> (x % 8));
+            EXPECT_EQ(data[(row + 3) * 32 + x] == C::Black, is_black) << x << ", " << row;
+        }
+        EXPECT_EQ(0, band[row * 5 + 4]);
+    }
+}
+
+class LevelOfDetail : public Blocks
+{
+protected:
+    /** \brief Collapses each pixel_size square of square pixel data by majority, one pixel at a time. */
+    static QuadTree::Data collapse_pixels(const QuadTree::Data& data, size_t pixel_size)
+    {
+        size_t side_length = sqrt(data.size());
+        size_t lod_side_length = side_length / pixel_size;
+        QuadTree::Data collapsed;
+        for (size_t y = 0; y < lod_side_length; ++y) {
+            for (size_t x = 0; x < lod_side_length; ++x) {
+                size_t black_pixels = 0;
+                for (size_t row = 0; row < pixel_size; ++row) {
+                    for (size_t col = 0; col < pixel_size; ++col) {
+                        auto ndx = (y * pixel_size + row) * side_length + x * pixel_size + col;
+                        black_pixels += data[ndx] == C::Black;
+                    }
+                }
+                collapsed.push_back(2 * black_pixels > pixel_size * pixel_size ? C::Black : C::White);
+            }
+        }
+        return collapsed;
+    }
+};
+
+TEST_F(LevelOfDetail, InvalidTree_DecodesEmpty)
+{
+    EXPECT_TRUE(sut.decode(3).empty());
+    EXPECT_TRUE(sut.render_thumbnail(4).empty());
+}
+
+TEST_F(LevelOfDetail, ZeroDepth_CollapsesWholeImage)
+{
+    QuadTree::Data data = {
+        C::Black, C::White,
+        C::Black, C::Black
+    };
+    sut.init(data);
+
+    EXPECT_EQ(QuadTree::Data{C::Black}, sut.decode(0));
+    EXPECT_EQ(QuadTree::Data{C::Black}, sut.decode(0, QuadTree::Collapse::AnyBlack));
+    EXPECT_EQ(QuadTree::Data{C::White}, sut.decode(0, QuadTree::Collapse::AllBlack));
+}
+
+TEST_F(LevelOfDetail, FullDepth_MatchesDecode)
+{
+    sut.init(make_noise(32));
+
+    EXPECT_EQ(sut.decode(), sut.decode(5));
+    EXPECT_EQ(sut.decode(), sut.decode(100));
+}
+
+TEST_F(LevelOfDetail, EachDepth_MatchesCollapsingPixels)
+{
+    auto data = make_noise(32);
+    for (size_t ndx = 0; ndx < 16 * 32; ndx += 32) {
+        std::fill(data.begin() + ndx, data.begin() + ndx + 16, C::Black);
+    }
+    sut.init(data);
+
+    for (size_t depth = 0; depth <= 5; ++depth) {
+        EXPECT_EQ(collapse_pixels(data, 32 >> depth), sut.decode(depth)) << depth;
+    }
+}
+
+TEST_F(LevelOfDetail, RulesAgreeOnHomogenousQuadrants)
+{
+    QuadTree::Data data(16 * 16, C::White);
+    data[0] = C::Black;
+    for (size_t ndx = 8 * 16; ndx < data.size(); ++ndx) {
+        data[ndx] = C::Black;
+    }
+    sut.init(data);
+
+    QuadTree::Data any_black = { C::Black, C::White, C::Black, C::Black };
+    QuadTree::Data all_black = { C::White, C::White, C::Black, C::Black };
+    EXPECT_EQ(any_black, sut.decode(1, QuadTree::Collapse::AnyBlack));
+    EXPECT_EQ(all_black, sut.decode(1, QuadTree::Collapse::AllBlack));
+    EXPECT_EQ(all_black, sut.decode(1, QuadTree::Collapse::Majority));
+}
+
+TEST_F(LevelOfDetail, Thumbnail_SamplesShallowestLevelLargeEnough)
+{
+    auto data = make_noise(64);
+    sut.init(data);
+
+    EXPECT_EQ(sut.decode(3), sut.render_thumbnail(8));
+    EXPECT_EQ(sut.decode(), sut.render_thumbnail(64));
+    EXPECT_EQ(100 * 100, sut.render_thumbnail(100).size());
+
+    auto lod = sut.decode(3);
+    auto thumbnail = sut.render_thumbnail(5);
+    ASSERT_EQ(5 * 5, thumbnail.size());
+    for (size_t y = 0; y < 5; ++y) {
+        for (size_t x = 0; x < 5; ++x) {
+            EXPECT_EQ(lod[((2 * y + 1) * 8 / 10) * 8 + (2 * x + 1) * 8 / 10], thumbnail[y * 5 + x]);
+        }
+    }
+}
+
+class RunLength : public Blocks
+{
+protected:
+    /** \brief Run-length encodes square pixel data, one scanline at a time. */
+    static std::vector<QuadTree::Runs> encode_runs(const QuadTree::Data& data)
+    {
+        size_t side_length = sqrt(data.size());
+        std::vector<QuadTree::Runs> rows(side_length);
+        for (size_t y = 0; y < side_length; ++y) {
+            auto color = C::White;
+            for (size_t x = 0; x < side_length; ++x) {
+                if (data[y * side_length + x] != color) {
+                    color = data[y * side_length + x];
+                    rows[y].push_back(x);
+                }
+            }
+        }
+        return rows;
+    }
+};
+
+TEST_F(RunLength, InvalidRuns_AreRejected)
+{
+    sut.init(std::vector<QuadTree::Runs>(), 12);
+    EXPECT_FALSE(sut.is_valid());
+
+    sut.init(std::vector<QuadTree::Runs>(5), 4);
+    EXPECT_FALSE(sut.is_valid());
+
+    sut.init(std::vector<QuadTree::Runs>{ {2, 2} }, 4);
+    EXPECT_FALSE(sut.is_valid());
+
+    sut.init(std::vector<QuadTree::Runs>{ {5} }, 4);
+    EXPECT_FALSE(sut.is_valid());
+}
+
+TEST_F(RunLength, MissingRows_AreWhite)
+{
+    sut.init(std::vector<QuadTree::Runs>(), 64);
+    ASSERT_TRUE(sut.is_valid());
+    EXPECT_TRUE(root_of(sut)->is_leaf());
+    EXPECT_EQ(C::White, root_of(sut)->get_color_value());
+
+    sut.init(std::vector<QuadTree::Runs>{ {0, 1} }, 2);
+    QuadTree::Data expected = { C::Black, C::White, C::White, C::White };
+    EXPECT_EQ(expected, sut.decode());
+}
+
+TEST_F(RunLength, MatchesInitFromPixels)
+{
+    for (size_t side_length : {1, 2, 4, 8, 32, 64}) {
+        auto data = make_noise(side_length);
+
+        // blank and solid margins exercise the shared row links
+        for (size_t ndx = 0; ndx < data.size() / 4; ++ndx) {
+            data[ndx] = C::White;
+            data[data.size() - 1 - ndx] = C::Black;
+        }
+
+        QuadTree expected;
+        expected.init(data);
+        sut.init(encode_runs(data), side_length);
+
+        ASSERT_TRUE(sut.is_valid()) << side_length;
+        EXPECT_EQ(expected, sut) << side_length;
+        EXPECT_EQ(data, sut.decode()) << side_length;
+    }
+}
+
+TEST_F(RunLength, WholeRowRuns_BecomeLargeLeaves)
+{
+    std::vector<QuadTree::Runs> rows(512, QuadTree::Runs{ 256 });
+    sut.init(rows, 512);
+
+    ASSERT_TRUE(sut.is_valid());
+    auto children = root_of(sut)->get_children();
+    EXPECT_TRUE(children.q1->is_leaf());
+    EXPECT_TRUE(children.q2->is_leaf());
+    EXPECT_EQ(C::Black, children.q1->get_color_value());
+    EXPECT_EQ(C::White, children.q2->get_color_value());
+}
+
+class Diffing : public Blocks
+{
+protected:
+    /** \brief Marks the pixels covered by regions, failing if any pixel is covered twice. */
+    static std::vector<bool> cover(const std::vector<QuadTree::Rect>& regions, size_t side_length)
+    {
+        std::vector<bool> covered(side_length * side_length, false);
+        for (const auto& region : regions) {
+            for (auto y = region.y; y < region.y + region.height; ++y) {
+                for (auto x = region.x; x < region.x + region.width; ++x) {
+                    EXPECT_FALSE(covered[y * side_length + x]) << x << ", " << y;
+                    covered[y * side_length + x] = true;
+                }
+            }
+        }
+        return covered;
+    }
+};
+
+TEST_F(Diffing, InvalidTreesOrSizes_AreRejected)
+{
+    QuadTree other;
+    std::vector<QuadTree::Rect> regions = { { 0, 0, 1, 1 } };
+    EXPECT_FALSE(sut.diff(other, regions));
+    EXPECT_TRUE(regions.empty());
+
+    sut.init(make_noise(16));
+    other.init(make_noise(32));
+    EXPECT_FALSE(sut.diff(other, regions));
+    EXPECT_FALSE(other.diff(sut, regions));
+}
+
+TEST_F(Diffing, IdenticalTrees_HaveNoDifference)
+{
+    sut.init(make_noise(64));
+    QuadTree other;
+    other.init(make_noise(64));
+
+    std::vector<QuadTree::Rect> regions;
+    ASSERT_TRUE(sut.diff(sut, regions));
+    EXPECT_TRUE(regions.empty());
+    ASSERT_TRUE(sut.diff(other, regions));
+    EXPECT_TRUE(regions.empty());
+}
+
+TEST_F(Diffing, EditedPixel_IsTheOnlyDifference)
+{
+    sut.init(make_noise(64));
+    auto color = sut.get_pixel(37, 21) == C::Black ? C::White : C::Black;
+    auto edited = sut.with_pixel(37, 21, color);
+
+    std::vector<QuadTree::Rect> regions;
+    ASSERT_TRUE(sut.diff(edited, regions));
+    ASSERT_EQ(1, regions.size());
+    EXPECT_EQ(37, regions[0].x);
+    EXPECT_EQ(21, regions[0].y);
+    EXPECT_EQ(1, regions[0].width);
+    EXPECT_EQ(1, regions[0].height);
+}
+
+TEST_F(Diffing, HomogenousQuadrants_DifferAsAWhole)
+{
+    QuadTree::Data data(64 * 64, C::White);
+    sut.init(data);
+    for (size_t y = 32; y < 64; ++y) {
+        std::fill(data.begin() + y * 64, data.begin() + y * 64 + 32, C::Black);
+    }
+    QuadTree other;
+    other.init(data);
+
+    std::vector<QuadTree::Rect> regions;
+    ASSERT_TRUE(sut.diff(other, regions));
+    ASSERT_EQ(1, regions.size());
+    EXPECT_EQ(0, regions[0].x);
+    EXPECT_EQ(32, regions[0].y);
+    EXPECT_EQ(32, regions[0].width);
+    EXPECT_EQ(32, regions[0].height);
+}
+
+TEST_F(Diffing, RegionsCoverExactlyTheDifferingPixels)
+{
+    for (size_t side_length : {4, 32, 64}) {
+        auto data = make_noise(side_length);
+        auto other_data = data;
+
+        // rewrite a quadrant, blank another, and flip a few scattered pixels
+        for (size_t y = 0; y < side_length / 2; ++y) {
+            for (size_t x = side_length / 2; x < side_length; ++x) {
+                other_data[y * side_length + x] = (x + y) % 3 ? C::Black : C::White;
+            }
+        }
+        for (size_t y = side_length / 2; y < side_length; ++y) {
+            std::fill(other_data.begin() + y * side_length,
+                      other_data.begin() + y * side_length + side_length / 2, C::White);
+        }
+        for (size_t ndx = 5; ndx < data.size(); ndx += 97) {
+            other_data[ndx] = other_data[ndx] == C::Black ? C::White : C::Black;
+        }
+
+        sut.init(data);
+        QuadTree other;
+        other.init(other_data);
+
+        std::vector<QuadTree::Rect> regions;
+        ASSERT_TRUE(sut.diff(other, regions));
+        auto covered = cover(regions, side_length);
+        for (size_t ndx = 0; ndx < data.size(); ++ndx) {
+            EXPECT_EQ(data[ndx] != other_data[ndx], covered[ndx]) << side_length << ": " << ndx;
+        }
+    }
+}
+
+class Cropping : public Blocks
+{
+protected:
+    /** \brief Copies the pixels of a square window of square pixel data, white outside the data. */
+    static QuadTree::Data copy_pixels(const QuadTree::Data& data, int64_t x_source,
+                                      int64_t y_source, size_t side_length, size_t width,
+                                      size_t height)
+    {
+        int64_t data_side_length = sqrt(data.size());
+        QuadTree::Data copied(side_length * side_length, C::White);
+        for (size_t y = 0; y < height; ++y) {
+            for (size_t x = 0; x < width; ++x) {
+                auto source_x = x_source + int64_t(x);
+                auto source_y = y_source + int64_t(y);
+                if (source_x >= 0 && source_y >= 0 &&
+                    source_x < data_side_length && source_y < data_side_length) {
+                    copied[y * side_length + x] = data[source_y * data_side_length + source_x];
+                }
+            }
+        }
+        return copied;
+    }
+};
+
+TEST_F(Cropping, InvalidTreeOrRegion_IsInvalid)
+{
+    EXPECT_FALSE(sut.crop({ 0, 0, 1, 1 }).is_valid());
+    EXPECT_FALSE(sut.translate(1, 1).is_valid());
+
+    sut.init(make_noise(16));
+    EXPECT_FALSE(sut.crop({ 0, 0, 0, 4 }).is_valid());
+    EXPECT_FALSE(sut.crop({ 16, 0, 1, 1 }).is_valid());
+    EXPECT_FALSE(sut.crop({ 8, 8, 9, 4 }).is_valid());
+}
+
+TEST_F(Cropping, AlignedQuadrant_SharesSubtree)
+{
+    sut.init(make_noise(64));
+    auto cropped = sut.crop({ 32, 0, 32, 32 });
+
+    EXPECT_EQ(root_of(sut)->get_children().q1, root_of(cropped));
+}
+
+TEST_F(Cropping, ArbitraryRegions_MatchCroppingPixels)
+{
+    auto data = make_noise(64);
+    sut.init(data);
+
+    QuadTree::Rect regions[] = {
+        { 0, 0, 64, 64 }, { 3, 5, 20, 9 }, { 16, 40, 16, 16 }, { 63, 63, 1, 1 }, { 10, 0, 33, 64 }
+    };
+    for (const auto& region : regions) {
+        auto cropped = sut.crop(region);
+        ASSERT_TRUE(cropped.is_valid());
+
+        auto side_length = cropped.get_side_length();
+        QuadTree expected;
+        expected.init(copy_pixels(data, region.x, region.y, side_length, region.width,
+                                  region.height));
+        EXPECT_EQ(expected, cropped) << region.x << ", " << region.y;
+    }
+}
+
+TEST_F(Cropping, TranslateByAlignedOffset_SharesSubtrees)
+{
+    sut.init(make_noise(64));
+    auto moved = sut.translate(32, -32);
+
+    auto children = root_of(moved)->get_children();
+    EXPECT_EQ(root_of(sut)->get_children().q3, children.q1);
+    EXPECT_EQ(C::White, children.q2->get_color_value());
+    EXPECT_EQ(C::White, children.q3->get_color_value());
+    EXPECT_EQ(C::White, children.q4->get_color_value());
+}
+
+TEST_F(Cropping, ArbitraryOffsets_MatchMovingPixels)
+{
+    auto data = make_noise(32);
+    sut.init(data);
+
+    int64_t offsets[][2] = { {0, 0}, {1, 0}, {-3, 7}, {13, -21}, {8, 16}, {-31, 31}, {40, 0} };
+    for (const auto& offset : offsets) {
+        QuadTree expected;
+        expected.init(copy_pixels(data, -offset[0], -offset[1], 32, 32, 32));
+
+        EXPECT_EQ(expected, sut.translate(offset[0], offset[1])) << offset[0] << ", " << offset[1];
+    }
+}
+
+class Morphology : public Blocks
+{
+protected:
+    /** \brief Dilates or erodes square pixel data by a square element, one pixel at a time. */
+    static QuadTree::Data morph_pixels(const QuadTree::Data& data, size_t radius, C spreading)
+    {
+        int64_t side_length = sqrt(data.size());
+        int64_t reach = radius;
+        QuadTree::Data morphed(data.size());
+        for (int64_t y = 0; y < side_length; ++y) {
+            for (int64_t x = 0; x < side_length; ++x) {
+                bool is_spread = false;
+                for (auto wy = std::max<int64_t>(0, y - reach);
+                     wy <= std::min(side_length - 1, y + reach); ++wy) {
+                    for (auto wx = std::max<int64_t>(0, x - reach);
+                         wx <= std::min(side_length - 1, x + reach); ++wx) {
+                        is_spread = is_spread || data[wy * side_length + wx] == spreading;
+                    }
+                }
+                auto retreating = spreading == C::Black ? C::White : C::Black;
+                morphed[y * side_length + x] = is_spread ? spreading : retreating;
+            }
+        }
+        return morphed;
+    }
+};
+
+TEST_F(Morphology, InvalidTree_IsInvalid)
+{
+    EXPECT_FALSE(sut.dilate(1).is_valid());
+    EXPECT_FALSE(sut.erode(1).is_valid());
+    EXPECT_FALSE(sut.open(1).is_valid());
+    EXPECT_FALSE(sut.close(1).is_valid());
+}
+
+TEST_F(Morphology, ZeroRadius_SharesTree)
+{
+    sut.init(make_noise(16));
+
+    EXPECT_EQ(root_of(sut), root_of(sut.dilate(0)));
+    EXPECT_EQ(root_of(sut), root_of(sut.erode(0)));
+}
+
+TEST_F(Morphology, DilatingAPixel_GrowsASquare)
+{
+    QuadTree::Data data(64 * 64, C::White);
+    data[10 * 64 + 20] = C::Black;
+    sut.init(data);
+
+    auto dilated = sut.dilate(3);
+    EXPECT_EQ(C::Black, dilated.get_region_color({ 17, 7, 7, 7 }));
+    EXPECT_EQ(49, root_of(dilated)->get_black_pixels());
+    EXPECT_EQ(sut, dilated.erode(3));
+}
+
+TEST_F(Morphology, DilateAndErode_MatchMorphingPixels)
+{
+    for (size_t side_length : {4, 32, 64}) {
+        auto data = make_noise(side_length);
+        for (size_t y = side_length / 4; y < side_length / 2; ++y) {
+            std::fill(data.begin() + y * side_length, data.begin() + (y + 1) * side_length, C::Black);
+        }
+        sut.init(data);
+
+        for (size_t radius : {1, 2, 5}) {
+            QuadTree dilated;
+            dilated.init(morph_pixels(data, radius, C::Black));
+            QuadTree eroded;
+            eroded.init(morph_pixels(data, radius, C::White));
+
+            EXPECT_EQ(dilated, sut.dilate(radius)) << side_length << ", " << radius;
+            EXPECT_EQ(eroded, sut.erode(radius)) << side_length << ", " << radius;
+        }
+    }
+}
+
+TEST_F(Morphology, OpenAndClose_ComposeDilateAndErode)
+{
+    sut.init(make_noise(32));
+
+    EXPECT_EQ(sut.erode(2).dilate(2), sut.open(2));
+    EXPECT_EQ(sut.dilate(2).erode(2), sut.close(2));
+    EXPECT_EQ(sut.open(1), sut.open(1).open(1));
+}
+
+TEST_F(Morphology, BlankPage_StaysASingleLeaf)
+{
+    sut.init(QuadTree::Data(1024 * 1024, C::White));
+
+    EXPECT_TRUE(root_of(sut.dilate(4))->is_leaf());
+    EXPECT_TRUE(root_of(sut.close(4))->is_leaf());
+}
+
+class Aggregates : public Blocks
+{
+protected:
+    /** \brief Finds the bounding box of the black pixels of square pixel data, one at a time. */
+    static bool bound_pixels(const QuadTree::Data& data, QuadTree::Rect& bounds)
+    {
+        size_t side_length = sqrt(data.size());
+        size_t x_begin = side_length, y_begin = side_length, x_end = 0, y_end = 0;
+        for (size_t ndx = 0; ndx < data.size(); ++ndx) {
+            if (data[ndx] == C::Black) {
+                x_begin = std::min(x_begin, ndx % side_length);
+                y_begin = std::min(y_begin, ndx / side_length);
+                x_end = std::max(x_end, ndx % side_length + 1);
+                y_end = std::max(y_end, ndx / side_length + 1);
+            }
+        }
+        bounds = { x_begin, y_begin, x_end - x_begin, y_end - y_begin };
+        return x_end != 0;
+    }
+
+    /** \brief Checks a tree's cached aggregates against those of a tree built from its pixels. */
+    static void expect_rebuilt_aggregates(const QuadTree& tree)
+    {
+        QuadTree rebuilt;
+        rebuilt.init(tree.decode());
+
+        QuadTree::Rect bounds, expected;
+        ASSERT_EQ(bound_pixels(tree.decode(), expected), tree.get_content_bounds(bounds));
+        if (tree.get_content_bounds(bounds)) {
+            EXPECT_EQ(expected.x, bounds.x);
+            EXPECT_EQ(expected.y, bounds.y);
+            EXPECT_EQ(expected.width, bounds.width);
+            EXPECT_EQ(expected.height, bounds.height);
+        }
+        EXPECT_EQ(rebuilt.get_node_count(), tree.get_node_count());
+        EXPECT_EQ(rebuilt.get_depth(), tree.get_depth());
+        EXPECT_EQ(rebuilt.is_blank(), tree.is_blank());
+    }
+};
+
+TEST_F(Aggregates, InvalidTree_HasNoAggregates)
+{
+    QuadTree::Rect bounds;
+    EXPECT_FALSE(sut.is_blank());
+    EXPECT_FALSE(sut.get_content_bounds(bounds));
+    EXPECT_FALSE(sut.crop_to_content().is_valid());
+    EXPECT_EQ(0, sut.get_node_count());
+    EXPECT_EQ(0, sut.get_depth());
+}
+
+TEST_F(Aggregates, BlankPage)
+{
+    sut.init(QuadTree::Data(256 * 256, C::White));
+
+    QuadTree::Rect bounds;
+    EXPECT_TRUE(sut.is_blank());
+    EXPECT_FALSE(sut.get_content_bounds(bounds));
+    EXPECT_FALSE(sut.crop_to_content().is_valid());
+    EXPECT_EQ(1, sut.get_node_count());
+    EXPECT_EQ(0, sut.get_depth());
+}
+
+TEST_F(Aggregates, MaintainedThroughEditsAndTransforms)
+{
+    QuadTree::Data data(64 * 64, C::White);
+    for (size_t y = 20; y < 30; ++y) {
+        for (size_t x = 5; x < 41; ++x) {
+            data[y * 64 + x] = (x * y) % 5 ? C::Black : C::White;
+        }
+    }
+    sut.init(data);
+
+    expect_rebuilt_aggregates(sut);
+    expect_rebuilt_aggregates(sut.with_pixel(60, 2, C::Black));
+    expect_rebuilt_aggregates(sut.rotate(QuadTree::Rotation::Clockwise90));
+    expect_rebuilt_aggregates(sut.rotate(QuadTree::Rotation::Clockwise270));
+    expect_rebuilt_aggregates(sut.flip(QuadTree::Flip::Horizontal));
+    expect_rebuilt_aggregates(sut.flip(QuadTree::Flip::Vertical));
+    expect_rebuilt_aggregates(sut.translate(-3, 17));
+    expect_rebuilt_aggregates(sut.dilate(2));
+}
+
+TEST_F(Aggregates, CropToContent)
+{
+    QuadTree::Data data(64 * 64, C::White);
+    data[10 * 64 + 12] = C::Black;
+    data[13 * 64 + 30] = C::Black;
+    sut.init(data);
+
+    auto cropped = sut.crop_to_content();
+    ASSERT_EQ(32, cropped.get_side_length());
+    EXPECT_EQ(C::Black, cropped.get_pixel(0, 0));
+    EXPECT_EQ(C::Black, cropped.get_pixel(18, 3));
+    EXPECT_EQ(2, root_of(cropped)->get_black_pixels());
+}
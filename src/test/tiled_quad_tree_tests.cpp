@@ -0,0 +1,131 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "tiled_quad_tree.hpp"
+
+using namespace testing;
+using C = QuadNode::ColorValue;
+using Data = TiledQuadTree::Data;
+using Rotation = TiledQuadTree::Rotation;
+
+class TestableTiledQuadTree : public Test
+{
+protected:
+    TiledQuadTree sut;
+
+    /** \brief Rotates row-major pixel data a quarter turn clockwise, one pixel at a time. */
+    static Data rotate_pixels(const Data& data, size_t width, size_t height)
+    {
+        Data rotated(data.size());
+        for (size_t y = 0; y < height; ++y) {
+            for (size_t x = 0; x < width; ++x) {
+                rotated[x * height + (height - 1 - y)] = data[y * width + x];
+            }
+        }
+        return rotated;
+    }
+
+    /** \brief Creates a width * height image with a recognizable, asymmetric pattern. */
+    static Data make_image(size_t width, size_t height)
+    {
+        Data data;
+        for (size_t y = 0; y < height; ++y) {
+            for (size_t x = 0; x < width; ++x) {
+                data.push_back((x * 7 + y * 3) % 5 < 2 || x == 0 ? C::Black : C::White);
+            }
+        }
+        return data;
+    }
+};
+
+class Initialization : public TestableTiledQuadTree { };
+
+TEST_F(Initialization, Unitialized_TreeIsInvalid)
+{
+    EXPECT_FALSE(sut.is_valid());
+    EXPECT_TRUE(sut.decode().empty());
+}
+
+TEST_F(Initialization, GivenMismatchedDimensions_TreeIsInvalid)
+{
+    sut.init(make_image(3, 2), 2, 2, 2);
+    EXPECT_FALSE(sut.is_valid());
+}
+
+TEST_F(Initialization, GivenNonPowerOfTwoTiles_TreeIsInvalid)
+{
+    sut.init(make_image(6, 6), 6, 6, 3);
+    EXPECT_FALSE(sut.is_valid());
+
+    sut.init(make_image(6, 6), 6, 6, 0);
+    EXPECT_FALSE(sut.is_valid());
+}
+
+TEST_F(Initialization, CoversImageWithPaddedGridOfTiles)
+{
+    sut.init(make_image(5, 9), 5, 9, 4);
+    ASSERT_TRUE(sut.is_valid());
+
+    EXPECT_EQ(5, sut.get_width());
+    EXPECT_EQ(9, sut.get_height());
+    EXPECT_EQ(3, sut.get_rows());
+    EXPECT_EQ(2, sut.get_columns());
+
+    // the bottom-right tile holds a single pixel of the image, the rest is padding
+    QuadTree expected;
+    Data corner(16, C::White);
+    corner[0] = make_image(5, 9).back();
+    expected.init(corner);
+    EXPECT_EQ(expected, sut.get_tile(2, 1));
+}
+
+class Decoding : public TestableTiledQuadTree { };
+
+TEST_F(Decoding, DecodedDataMatchesInitializationData)
+{
+    auto data = make_image(13, 7);
+    sut.init(data, 13, 7, 4);
+
+    EXPECT_EQ(data, sut.decode());
+}
+
+class Rotating : public TestableTiledQuadTree { };
+
+TEST_F(Rotating, InvalidTree_RotatesToInvalidTree)
+{
+    EXPECT_FALSE(sut.rotate(Rotation::Clockwise90).is_valid());
+}
+
+TEST_F(Rotating, QuarterTurns_ReorderGridAndTiles)
+{
+    size_t width = 13;
+    size_t height = 7;
+    auto expected = make_image(width, height);
+    sut.init(expected, width, height, 4);
+
+    auto rotated = sut;
+    for (int turn = 0; turn < 4; ++turn) {
+        expected = rotate_pixels(expected, width, height);
+        std::swap(width, height);
+        rotated = rotated.rotate(Rotation::Clockwise90);
+
+        ASSERT_TRUE(rotated.is_valid());
+        EXPECT_EQ(width, rotated.get_width());
+        EXPECT_EQ(height, rotated.get_height());
+        EXPECT_EQ(expected, rotated.decode());
+    }
+}
+
+TEST_F(Rotating, HalfAndThreeQuarterTurns)
+{
+    auto data = make_image(6, 11);
+    sut.init(data, 6, 11, 4);
+
+    auto quarter = rotate_pixels(data, 6, 11);
+    auto half = rotate_pixels(quarter, 11, 6);
+    auto three_quarter = rotate_pixels(half, 6, 11);
+
+    EXPECT_EQ(half, sut.rotate(Rotation::Clockwise180).decode());
+    EXPECT_EQ(three_quarter, sut.rotate(Rotation::Clockwise270).decode());
+    EXPECT_EQ(data, sut.rotate(Rotation::None).decode());
+}
@@ -0,0 +1,142 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "image_writer.hpp"
+#include "tree_cache.hpp"
+
+using namespace testing;
+using C = QuadNode::ColorValue;
+
+class TestableTreeCache : public Test
+{
+protected:
+    const std::string path = "tree_cache_tests.pbm";
+    QuadTree tree;
+
+    void TearDown() override { std::remove(path.c_str()); }
+
+    /** \brief Writes a blank image with a single black pixel, of the given size. */
+    QuadTree write_image(size_t side_length)
+    {
+        QuadTree::Data data(side_length * side_length, C::White);
+        data[0] = C::Black;
+
+        QuadTree written;
+        written.init(data);
+        EXPECT_TRUE(ImageWriter(ImageWriter::Format::Pbm).write(written, path));
+        return written;
+    }
+};
+
+class Lookup : public TestableTreeCache { };
+
+TEST_F(Lookup, UnknownNames_AreMisses)
+{
+    TreeCache sut;
+    EXPECT_FALSE(sut.get("no_such_file.pbm", tree));
+    EXPECT_EQ(0, sut.get_size());
+}
+
+TEST_F(Lookup, FilesAreReadOnceThenServedFromCache)
+{
+    auto expected = write_image(16);
+    TreeCache sut;
+
+    ASSERT_TRUE(sut.get(path, tree));
+    EXPECT_EQ(expected, tree);
+    EXPECT_EQ(1, sut.get_misses());
+
+    ASSERT_TRUE(sut.get(path, tree));
+    EXPECT_EQ(expected, tree);
+    EXPECT_EQ(1, sut.get_misses());
+    EXPECT_EQ(1, sut.get_hits());
+}
+
+TEST_F(Lookup, ChangedFilesAreReadAgain)
+{
+    write_image(16);
+    TreeCache sut;
+    ASSERT_TRUE(sut.get(path, tree));
+
+    auto expected = write_image(32);
+    ASSERT_TRUE(sut.get(path, tree));
+    EXPECT_EQ(expected, tree);
+    EXPECT_EQ(2, sut.get_misses());
+    EXPECT_EQ(1, sut.get_size());
+}
+
+TEST_F(Lookup, StoredTreesAreServedByName)
+{
+    auto expected = write_image(8);
+    TreeCache sut;
+
+    sut.put("rotated", expected);
+    ASSERT_TRUE(sut.get("rotated", tree));
+    EXPECT_EQ(expected, tree);
+    EXPECT_EQ(1, sut.get_hits());
+}
+
+class Eviction : public TestableTreeCache { };
+
+TEST_F(Eviction, LeastRecentlyUsedEntriesAreEvicted)
+{
+    auto expected = write_image(8);
+    TreeCache sut(2);
+
+    sut.put("one", expected);
+    sut.put("two", expected);
+    ASSERT_TRUE(sut.get("one", tree));
+
+    sut.put("three", expected);
+    EXPECT_EQ(2, sut.get_size());
+    EXPECT_TRUE(sut.get("one", tree));
+    EXPECT_TRUE(sut.get("three", tree));
+    EXPECT_FALSE(sut.get("two", tree));
+}
+
+TEST_F(Eviction, SnapshotsOutliveTheirEntries)
+{
+    auto expected = write_image(8);
+    TreeCache sut(1);
+
+    sut.put("one", expected);
+    ASSERT_TRUE(sut.get("one", tree));
+    sut.put("two", QuadTree());
+
+    EXPECT_EQ(expected, tree);
+}
+
+class Concurrency : public TestableTreeCache { };
+
+TEST_F(Concurrency, ManyClientsShareOneCache)
+{
+    auto expected = write_image(64);
+    TreeCache sut;
+
+    std::vector<std::thread> clients;
+    std::vector<int> successes(8, 0);
+    for (size_t client = 0; client < successes.size(); ++client) {
+        clients.emplace_back([&, client]() {
+            for (int request = 0; request < 50; ++request) {
+                QuadTree snapshot;
+                if (sut.get(path, snapshot) && snapshot == expected) {
+                    ++successes[client];
+                }
+                sut.put("client" + std::to_string(client), snapshot);
+            }
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+
+    for (auto count : successes) {
+        EXPECT_EQ(50, count);
+    }
+    EXPECT_EQ(400, sut.get_hits() + sut.get_misses());
+}
@@ -0,0 +1,126 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+
+#include "image_writer.hpp"
+#include "tree_server.hpp"
+
+using namespace testing;
+using C = QuadNode::ColorValue;
+
+class TestableTreeServer : public Test
+{
+protected:
+    const std::string path = "tree_server_tests.pbm";
+    const std::string output = "tree_server_tests_output.bmp";
+
+    TreeCache cache;
+    TreeServer sut;
+    QuadTree image;
+
+    TestableTreeServer() :
+        sut(cache)
+    {
+        // a blank image, with a black top row
+        QuadTree::Data data(16 * 16, C::White);
+        for (size_t x = 0; x < 16; ++x) {
+            data[x] = C::Black;
+        }
+        image.init(data);
+        ImageWriter(ImageWriter::Format::Pbm).write(image, path);
+    }
+
+    void TearDown() override
+    {
+        std::remove(path.c_str());
+        std::remove(output.c_str());
+    }
+};
+
+class Commands : public TestableTreeServer { };
+
+TEST_F(Commands, MalformedCommands_AreErrors)
+{
+    EXPECT_EQ("error empty command", sut.execute(""));
+    EXPECT_EQ("error unknown command: frobnicate", sut.execute("frobnicate"));
+    EXPECT_EQ("error unknown command: load", sut.execute("load"));
+    EXPECT_EQ("error unable to load: missing.pbm", sut.execute("load missing.pbm"));
+    EXPECT_EQ("error invalid number: ten", sut.execute("rotate " + path + " ten result"));
+}
+
+TEST_F(Commands, OutOfRangeAmounts_AreErrors)
+{
+    EXPECT_EQ("error invalid number: inf", sut.execute("rotate " + path + " inf result"));
+    EXPECT_EQ("error invalid number: nan", sut.execute("scale " + path + " nan result"));
+    EXPECT_EQ("error scaled image too large: 1e300", sut.execute("scale " + path + " 1e300 result"));
+    EXPECT_EQ("error scaled image too large: 2048", sut.execute("scale " + path + " 2048 result"));
+
+    // huge quarter turns are reduced to a single turn
+    EXPECT_EQ("ok 16", sut.execute("rotate " + path + " 9e299 result"));
+    EXPECT_EQ("ok 16", sut.execute("rotate " + path + " -1e300 result"));
+}
+
+TEST_F(Commands, Load)
+{
+    EXPECT_EQ("ok 16", sut.execute("load " + path));
+    EXPECT_EQ(1, cache.get_size());
+}
+
+TEST_F(Commands, Query)
+{
+    EXPECT_EQ("ok 16 16", sut.execute("query " + path));
+    EXPECT_EQ("ok black", sut.execute("query " + path + " 3 0"));
+    EXPECT_EQ("ok white", sut.execute("query " + path + " 3 1"));
+    EXPECT_EQ("error out of bounds", sut.execute("query " + path + " 16 0"));
+}
+
+TEST_F(Commands, RotateStoresResultUnderNewName)
+{
+    EXPECT_EQ("ok 16", sut.execute("rotate " + path + " 90 rotated"));
+    EXPECT_EQ("ok black", sut.execute("query rotated 15 3"));
+    EXPECT_EQ("ok white", sut.execute("query rotated 0 3"));
+
+    EXPECT_EQ("ok 16", sut.execute("rotate rotated -90 back"));
+    EXPECT_EQ("ok black", sut.execute("query back 3 0"));
+
+    EXPECT_EQ("ok 16", sut.execute("rotate " + path + " 12.5 tilted"));
+}
+
+TEST_F(Commands, Scale)
+{
+    EXPECT_EQ("ok 32", sut.execute("scale " + path + " 2 big"));
+    EXPECT_EQ("ok 32 64", sut.execute("query big"));
+    EXPECT_EQ("error unable to scale by 0", sut.execute("scale " + path + " 0 nothing"));
+}
+
+TEST_F(Commands, Write)
+{
+    EXPECT_EQ("ok", sut.execute("write " + path + " " + output));
+    EXPECT_EQ("ok 16 16", sut.execute("query " + output));
+    EXPECT_EQ("error unsupported output format: out.png", sut.execute("write " + path + " out.png"));
+}
+
+class Sessions : public TestableTreeServer { };
+
+TEST_F(Sessions, ServeAnswersEachLineUntilQuit)
+{
+    std::istringstream in("load " + path + "\n\nquery " + path + " 0 0\nquit\nload " + path + "\n");
+    std::ostringstream out;
+
+    sut.serve(in, out);
+    EXPECT_EQ("ok 16\nok black\nok\n", out.str());
+}
+
+TEST_F(Sessions, TreesStayResidentAcrossSessions)
+{
+    std::istringstream first("load " + path + "\n");
+    std::istringstream second("query " + path + "\n");
+    std::ostringstream out;
+
+    sut.serve(first, out);
+    sut.serve(second, out);
+    EXPECT_EQ(1, cache.get_misses());
+    EXPECT_EQ(1, cache.get_hits());
+}
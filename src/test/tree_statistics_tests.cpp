@@ -0,0 +1,225 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+
+#include "tree_statistics.hpp"
+
+using namespace testing;
+using C = QuadNode::ColorValue;
+using Connectivity = TreeStatistics::Connectivity;
+using Component = TreeStatistics::Component;
+
+class TestableTreeStatistics : public Test
+{
+protected:
+    QuadTree tree;
+
+    /** \brief Creates an image of random rectangles and sparse noise. */
+    static QuadTree::Data make_drawing(size_t side_length, unsigned seed)
+    {
+        std::mt19937 random(seed);
+        QuadTree::Data data(side_length * side_length, C::White);
+
+        for (int rect = 0; rect < 12; ++rect) {
+            size_t x = random() % side_length;
+            size_t y = random() % side_length;
+            size_t width = 1 + random() % (side_length / 4);
+            size_t height = 1 + random() % (side_length / 4);
+            for (auto row = y; row < std::min(side_length, y + height); ++row) {
+                for (auto col = x; col < std::min(side_length, x + width); ++col) {
+                    data[row * side_length + col] = C::Black;
+                }
+            }
+        }
+
+        for (size_t ndx = 0; ndx < data.size(); ++ndx) {
+            if (random() % 9 == 0) {
+                data[ndx] = C::Black;
+            }
+        }
+        return data;
+    }
+
+    /** \brief Labels connected components one pixel at a time, with a flood fill. */
+    static std::vector<Component> flood_fill(
+            const QuadTree::Data& data, size_t side_length, Connectivity connectivity)
+    {
+        std::vector<bool> visited(data.size(), false);
+        std::vector<Component> components;
+
+        for (size_t start = 0; start < data.size(); ++start) {
+            if (visited[start] || data[start] != C::Black) {
+                continue;
+            }
+
+            size_t left = side_length, top = side_length, right = 0, bottom = 0, count = 0;
+            std::vector<size_t> stack = {start};
+            visited[start] = true;
+            while (!stack.empty()) {
+                auto ndx = stack.back();
+                stack.pop_back();
+
+                long x = ndx % side_length;
+                long y = ndx / side_length;
+                left = std::min<size_t>(left, x);
+                right = std::max<size_t>(right, x + 1);
+                top = std::min<size_t>(top, y);
+                bottom = std::max<size_t>(bottom, y + 1);
+                ++count;
+
+                for (long dy = -1; dy <= 1; ++dy) {
+                    for (long dx = -1; dx <= 1; ++dx) {
+                        bool is_diagonal = dx != 0 && dy != 0;
+                        if ((dx == 0 && dy == 0) ||
+                            (is_diagonal && connectivity == Connectivity::Four)) {
+                            continue;
+                        }
+
+                        long nx = x + dx;
+                        long ny = y + dy;
+                        if (nx < 0 || ny < 0 || nx >= long(side_length) || ny >= long(side_length)) {
+                            continue;
+                        }
+
+                        auto neighbor = ny * side_length + nx;
+                        if (!visited[neighbor] && data[neighbor] == C::Black) {
+                            visited[neighbor] = true;
+                            stack.push_back(neighbor);
+                        }
+                    }
+                }
+            }
+
+            components.push_back({count, {left, top, right - left, bottom - top}});
+        }
+
+        return components;
+    }
+
+    static void sort(std::vector<Component>& components)
+    {
+        std::sort(components.begin(), components.end(), [](const Component& a, const Component& b) {
+            return std::make_tuple(a.bounds.y, a.bounds.x, a.black_pixels, a.bounds.width) <
+                   std::make_tuple(b.bounds.y, b.bounds.x, b.black_pixels, b.bounds.width);
+        });
+    }
+
+    static void expect_same(std::vector<Component> expected, std::vector<Component> actual)
+    {
+        sort(expected);
+        sort(actual);
+
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t ndx = 0; ndx < expected.size(); ++ndx) {
+            EXPECT_EQ(expected[ndx].black_pixels, actual[ndx].black_pixels);
+            EXPECT_EQ(expected[ndx].bounds.x, actual[ndx].bounds.x);
+            EXPECT_EQ(expected[ndx].bounds.y, actual[ndx].bounds.y);
+            EXPECT_EQ(expected[ndx].bounds.width, actual[ndx].bounds.width);
+            EXPECT_EQ(expected[ndx].bounds.height, actual[ndx].bounds.height);
+        }
+    }
+};
+
+class AreaStatistics : public TestableTreeStatistics { };
+
+TEST_F(AreaStatistics, InvalidTree_HasNoBlackPixels)
+{
+    QuadTree::Rect bounds;
+    EXPECT_EQ(0, TreeStatistics::count_black_pixels(tree));
+    EXPECT_FALSE(TreeStatistics::get_black_bounds(tree, bounds));
+    EXPECT_TRUE(TreeStatistics::find_components(tree).empty());
+}
+
+TEST_F(AreaStatistics, BlankImage_HasNoBlackPixels)
+{
+    tree.init(QuadTree::Data(64 * 64, C::White));
+
+    QuadTree::Rect bounds;
+    EXPECT_EQ(0, TreeStatistics::count_black_pixels(tree));
+    EXPECT_FALSE(TreeStatistics::get_black_bounds(tree, bounds));
+    EXPECT_TRUE(TreeStatistics::find_components(tree).empty());
+}
+
+TEST_F(AreaStatistics, CountsAndBoundsMatchPixels)
+{
+    auto data = make_drawing(64, 1);
+    tree.init(data);
+
+    size_t count = std::count(data.begin(), data.end(), C::Black);
+    EXPECT_EQ(count, TreeStatistics::count_black_pixels(tree));
+
+    auto everything = flood_fill(data, 64, Connectivity::Eight);
+    Component expected = everything.front();
+    for (const auto& component : everything) {
+        auto right = std::max(expected.bounds.x + expected.bounds.width,
+                              component.bounds.x + component.bounds.width);
+        auto bottom = std::max(expected.bounds.y + expected.bounds.height,
+                               component.bounds.y + component.bounds.height);
+        expected.bounds.x = std::min(expected.bounds.x, component.bounds.x);
+        expected.bounds.y = std::min(expected.bounds.y, component.bounds.y);
+        expected.bounds.width = right - expected.bounds.x;
+        expected.bounds.height = bottom - expected.bounds.y;
+    }
+
+    QuadTree::Rect bounds;
+    ASSERT_TRUE(TreeStatistics::get_black_bounds(tree, bounds));
+    EXPECT_EQ(expected.bounds.x, bounds.x);
+    EXPECT_EQ(expected.bounds.y, bounds.y);
+    EXPECT_EQ(expected.bounds.width, bounds.width);
+    EXPECT_EQ(expected.bounds.height, bounds.height);
+}
+
+class Components : public TestableTreeStatistics { };
+
+TEST_F(Components, DiagonalPixelsOnlyConnectWithEightConnectivity)
+{
+    tree.init({
+        C::Black, C::White, C::White, C::White,
+        C::White, C::Black, C::White, C::White,
+        C::White, C::White, C::Black, C::Black,
+        C::White, C::White, C::White, C::White
+    });
+
+    auto eight = TreeStatistics::find_components(tree, Connectivity::Eight);
+    ASSERT_EQ(1, eight.size());
+    EXPECT_EQ(4, eight[0].black_pixels);
+
+    auto four = TreeStatistics::find_components(tree, Connectivity::Four);
+    ASSERT_EQ(3, four.size());
+    EXPECT_EQ(1, four[0].black_pixels);
+    EXPECT_EQ(1, four[1].black_pixels);
+    EXPECT_EQ(2, four[2].black_pixels);
+    EXPECT_EQ(2, four[2].bounds.width);
+}
+
+TEST_F(Components, LargeLeavesAreSingleComponents)
+{
+    QuadTree::Data data(64 * 64, C::White);
+    for (size_t ndx = 0; ndx < 32 * 64; ++ndx) {
+        data[ndx] = (ndx % 64 < 32) ? C::Black : C::White;
+    }
+    data[63 * 64 + 63] = C::Black;
+    tree.init(data);
+
+    auto components = TreeStatistics::find_components(tree);
+    ASSERT_EQ(2, components.size());
+    EXPECT_EQ(32 * 32, components[0].black_pixels);
+    EXPECT_EQ(1, components[1].black_pixels);
+    EXPECT_EQ(63, components[1].bounds.x);
+}
+
+TEST_F(Components, MatchFloodFill)
+{
+    for (unsigned seed = 0; seed < 6; ++seed) {
+        auto data = make_drawing(64, seed);
+        tree.init(data);
+
+        expect_same(flood_fill(data, 64, Connectivity::Eight),
+                    TreeStatistics::find_components(tree, Connectivity::Eight));
+        expect_same(flood_fill(data, 64, Connectivity::Four),
+                    TreeStatistics::find_components(tree, Connectivity::Four));
+    }
+}
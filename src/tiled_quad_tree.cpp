@@ -0,0 +1,228 @@
+#include "tiled_quad_tree.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using ColorValue = QuadNode::ColorValue;
+
+constexpr size_t TiledQuadTree::DEFAULT_TILE_SIDE_LENGTH;
+
+TiledQuadTree::TiledQuadTree() :
+    width_(0),
+    height_(0),
+    tile_side_length_(0),
+    rows_(0),
+    columns_(0),
+    x_off_(0),
+    y_off_(0)
+{ }
+
+void
+TiledQuadTree::init(const Data& data, size_t width, size_t height, size_t tile_side_length)
+{
+    *this = TiledQuadTree();
+
+    bool is_power_of_two =
+        tile_side_length != 0 && (tile_side_length & (tile_side_length - 1)) == 0;
+    if (data.empty() || data.size() != width * height || !is_power_of_two) {
+        return;
+    }
+
+    width_ = width;
+    height_ = height;
+    tile_side_length_ = tile_side_length;
+    rows_ = (height + tile_side_length - 1) / tile_side_length;
+    columns_ = (width + tile_side_length - 1) / tile_side_length;
+
+    tiles_.resize(rows_ * columns_);
+    for_each_parallel(tiles_.size(), [&](size_t ndx) {
+        tiles_[ndx].init(parse_tile(data, ndx / columns_, ndx % columns_));
+    });
+}
+
+bool
+TiledQuadTree::is_valid() const
+{
+    if (tiles_.empty()) {
+        return false;
+    }
+
+    return std::all_of(tiles_.begin(), tiles_.end(), [](const QuadTree& tile) {
+        return tile.is_valid();
+    });
+}
+
+size_t
+TiledQuadTree::get_width() const
+{
+    return width_;
+}
+
+size_t
+TiledQuadTree::get_height() const
+{
+    return height_;
+}
+
+size_t
+TiledQuadTree::get_tile_side_length() const
+{
+    return tile_side_length_;
+}
+
+size_t
+TiledQuadTree::get_rows() const
+{
+    return rows_;
+}
+
+size_t
+TiledQuadTree::get_columns() const
+{
+    return columns_;
+}
+
+const QuadTree&
+TiledQuadTree::get_tile(size_t row, size_t column) const
+{
+    return tiles_[row * columns_ + column];
+}
+
+TiledQuadTree::Data
+TiledQuadTree::decode() const
+{
+    if (!is_valid()) {
+        return { };
+    }
+
+    Data data(width_ * height_, ColorValue::White);
+    for_each_parallel(tiles_.size(), [&](size_t ndx) {
+        auto tile = tiles_[ndx].decode();
+
+        // clip the tile against the image, which is offset within the padded grid
+        auto tile_x = (ndx % columns_) * tile_side_length_;
+        auto tile_y = (ndx / columns_) * tile_side_length_;
+        auto x_begin = std::max(tile_x, x_off_);
+        auto x_end = std::min(tile_x + tile_side_length_, x_off_ + width_);
+        auto y_begin = std::max(tile_y, y_off_);
+        auto y_end = std::min(tile_y + tile_side_length_, y_off_ + height_);
+
+        for (auto y = y_begin; y < y_end; ++y) {
+            auto row_start = tile.begin() + (y - tile_y) * tile_side_length_ + (x_begin - tile_x);
+            auto out_start = data.begin() + (y - y_off_) * width_ + (x_begin - x_off_);
+            std::copy(row_start, row_start + (x_end - x_begin), out_start);
+        }
+    });
+
+    return data;
+}
+
+TiledQuadTree
+TiledQuadTree::rotate(Rotation rotation) const
+{
+    if (!is_valid()) {
+        return TiledQuadTree();
+    }
+
+    auto padded_width = columns_ * tile_side_length_;
+    auto padded_height = rows_ * tile_side_length_;
+
+    TiledQuadTree rotated(*this);
+    switch (rotation) {
+    case Rotation::None:
+        break;
+    case Rotation::Clockwise90:
+        rotated.width_ = height_;
+        rotated.height_ = width_;
+        rotated.rows_ = columns_;
+        rotated.columns_ = rows_;
+        rotated.x_off_ = padded_height - y_off_ - height_;
+        rotated.y_off_ = x_off_;
+        break;
+    case Rotation::Clockwise180:
+        rotated.x_off_ = padded_width - x_off_ - width_;
+        rotated.y_off_ = padded_height - y_off_ - height_;
+        break;
+    case Rotation::Clockwise270:
+        rotated.width_ = height_;
+        rotated.height_ = width_;
+        rotated.rows_ = columns_;
+        rotated.columns_ = rows_;
+        rotated.x_off_ = y_off_;
+        rotated.y_off_ = padded_width - x_off_ - width_;
+        break;
+    }
+
+    for_each_parallel(tiles_.size(), [&](size_t ndx) {
+        auto row = ndx / columns_;
+        auto column = ndx % columns_;
+
+        // the grid turns along with the tiles, ie. a quarter turn clockwise moves the bottom-left
+        // tile to the top-left
+        size_t rotated_row = row;
+        size_t rotated_column = column;
+        switch (rotation) {
+        case Rotation::None:
+            break;
+        case Rotation::Clockwise90:
+            rotated_row = column;
+            rotated_column = rows_ - 1 - row;
+            break;
+        case Rotation::Clockwise180:
+            rotated_row = rows_ - 1 - row;
+            rotated_column = columns_ - 1 - column;
+            break;
+        case Rotation::Clockwise270:
+            rotated_row = columns_ - 1 - column;
+            rotated_column = row;
+            break;
+        }
+
+        auto rotated_ndx = rotated_row * rotated.columns_ + rotated_column;
+        rotated.tiles_[rotated_ndx] = tiles_[ndx].rotate(rotation);
+    });
+
+    return rotated;
+}
+
+TiledQuadTree::Data
+TiledQuadTree::parse_tile(const Data& data, size_t row, size_t column) const
+{
+    Data tile(tile_side_length_ * tile_side_length_, ColorValue::White);
+
+    auto tile_x = column * tile_side_length_;
+    auto tile_y = row * tile_side_length_;
+    auto tile_width = std::min(tile_side_length_, width_ - tile_x);
+    auto tile_height = std::min(tile_side_length_, height_ - tile_y);
+
+    for (size_t y = 0; y < tile_height; ++y) {
+        auto row_start = data.begin() + (tile_y + y) * width_ + tile_x;
+        std::copy(row_start, row_start + tile_width, tile.begin() + y * tile_side_length_);
+    }
+
+    return tile;
+}
+
+void
+TiledQuadTree::for_each_parallel(size_t count, const std::function<void(size_t)>& task)
+{
+    size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    auto thread_count = std::min(hardware_threads, count);
+
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count);
+
+    for (size_t ndx = 0; ndx < thread_count; ++ndx) {
+        workers.emplace_back([&]() {
+            for (auto task_ndx = next++; task_ndx < count; task_ndx = next++) {
+                task(task_ndx);
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "quad_tree.hpp"
+
+/** \brief Encodes a large, rectangular binary image as a grid of independent QuadTrees.
+ *
+ * A single QuadTree encodes a square image from one root, so every operation on it is one
+ * traversal of one tree. A TiledQuadTree instead covers the canvas with a grid of fixed-size,
+ * square tiles, each encoded by its own QuadTree. Tiles share no nodes, so they are built,
+ * rotated and decoded independently (and in parallel), and the memory held by any one tile is
+ * bounded by the tile side length.
+ *
+ * Tiles along the edges of the canvas are padded with white pixels. The canvas' offset within the
+ * padded grid is tracked, so padding never shows up in decode(), even after rotation moves it to
+ * the top or left of the grid.
+ *
+ * Like QuadTree, a TiledQuadTree is lazily initialized via init(), and clients check whether
+ * initialization was successful via is_valid(). */
+class TiledQuadTree
+{
+public:
+    using Data = QuadTree::Data;
+    using Rotation = QuadTree::Rotation;
+
+    /** \brief Tile side length used when none is passed to init(). */
+    static constexpr size_t DEFAULT_TILE_SIDE_LENGTH = 1024;
+
+    /** \brief Constructs an uninitialized TiledQuadTree.
+     *
+     * TiledQuadTrees are lazily initialized via init(). */
+    TiledQuadTree();
+
+    /** \brief Initializes this TiledQuadTree.
+     *
+     * Data is a contiguous, row-major array of the scanned pixels, as for QuadTree::init(), but
+     * the image need not be square. Each tile is built on its own thread.
+     *
+     * Initialization fails if data.size() != width * height, if the image is empty, or if the
+     * tile side length is not a power of two.
+     *
+     * \param data Binary image data.
+     * \param width The width of the image, in pixels.
+     * \param height The height of the image, in pixels.
+     * \param tile_side_length The side length of each tile, in pixels. */
+    void init(const Data& data, size_t width, size_t height,
+              size_t tile_side_length = DEFAULT_TILE_SIDE_LENGTH);
+
+    /** \brief Query validity of this tree.
+     *
+     * \return true iff this tree was initialized successfully, and all its tiles are valid. */
+    bool is_valid() const;
+
+    /** \brief Query the width of the encoded image.
+     *
+     * \return The image width, in pixels, or 0 if this tree is invalid. */
+    size_t get_width() const;
+
+    /** \brief Query the height of the encoded image.
+     *
+     * \return The image height, in pixels, or 0 if this tree is invalid. */
+    size_t get_height() const;
+
+    /** \brief Query the side length of each tile.
+     *
+     * \return The tile side length, in pixels, or 0 if this tree is invalid. */
+    size_t get_tile_side_length() const;
+
+    /** \brief Query the number of rows of tiles in the grid. */
+    size_t get_rows() const;
+
+    /** \brief Query the number of columns of tiles in the grid. */
+    size_t get_columns() const;
+
+    /** \brief Retrieve a single tile.
+     *
+     * Undefined behavior if row >= get_rows() or column >= get_columns().
+     *
+     * \param row The row of the tile in the grid, counted from the top.
+     * \param column The column of the tile in the grid, counted from the left.
+     * \return The QuadTree encoding the tile. */
+    const QuadTree& get_tile(size_t row, size_t column) const;
+
+    /** \brief Parses the encoded image back into pixel data.
+     *
+     * Each tile is decoded on its own thread, directly into the returned image.
+     *
+     * \return The width * height pixels encoded by this tree, or empty data if it is invalid. */
+    Data decode() const;
+
+    /** \brief Creates a rotated copy of this tree.
+     *
+     * Each tile is rotated on its own thread, \sa QuadTree::rotate(), and the grid itself is
+     * reordered to match. Rotating by a quarter turn swaps the width and height of the image.
+     *
+     * \param rotation The clockwise rotation to apply.
+     * \return The rotated tree, or an invalid tree if this tree is invalid. */
+    TiledQuadTree rotate(Rotation rotation) const;
+
+private:
+    size_t width_;            ///< Image width, in pixels
+    size_t height_;           ///< Image height, in pixels
+    size_t tile_side_length_; ///< Side length of each tile, in pixels
+    size_t rows_;             ///< Number of rows in the grid
+    size_t columns_;          ///< Number of columns in the grid
+    size_t x_off_;            ///< x offset of the image within the padded grid
+    size_t y_off_;            ///< y offset of the image within the padded grid
+
+    std::vector<QuadTree> tiles_; ///< Row-major storage for the grid of tiles
+
+    /** \brief Copies a single tile's pixels out of the image, padding with white.
+     *
+     * \param data The image data passed to init().
+     * \param row The row of the tile to copy.
+     * \param column The column of the tile to copy.
+     * \return The tile_side_length_ * tile_side_length_ pixels of the tile. */
+    Data parse_tile(const Data& data, size_t row, size_t column) const;
+
+    /** \brief Runs a task once for each index in [0, count), spread across hardware threads.
+     *
+     * Returns once every task has completed. Tasks must not touch shared state, other than
+     * writing to disjoint elements of a preallocated container.
+     *
+     * \param count The number of tasks to run.
+     * \param task The task to run, invoked with the index of each task. */
+    static void for_each_parallel(size_t count, const std::function<void(size_t)>& task);
+};
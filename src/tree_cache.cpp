@@ -0,0 +1,116 @@
+#include "tree_cache.hpp"
+
+#include <sys/stat.h>
+
+#include "image_reader.hpp"
+
+constexpr size_t TreeCache::DEFAULT_CAPACITY;
+
+TreeCache::TreeCache(size_t capacity) :
+    capacity_(capacity == 0 ? 1 : capacity),
+    hits_(0),
+    misses_(0)
+{ }
+
+bool
+TreeCache::get(const std::string& name, QuadTree& tree)
+{
+    FileVersion version;
+    bool is_file = stat_file(name, version);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto found = index_.find(name);
+        if (found != index_.end()) {
+            const auto& entry = *found->second;
+            bool is_current = !entry.is_file || (is_file &&
+                entry.version.modified.tv_sec == version.modified.tv_sec &&
+                entry.version.modified.tv_nsec == version.modified.tv_nsec &&
+                entry.version.size == version.size);
+
+            if (is_current) {
+                entries_.splice(entries_.begin(), entries_, found->second);
+                tree = entry.tree;
+                ++hits_;
+                return true;
+            }
+        }
+
+        if (!is_file) {
+            return false;
+        }
+        ++misses_;
+    }
+
+    // read outside of the lock, another client may read the same file concurrently, in which case
+    // the last one in wins, and both get a valid tree
+    QuadTree loaded;
+    if (!ImageReader::read(name, loaded)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    insert({name, loaded, true, version});
+    tree = loaded;
+    return true;
+}
+
+void
+TreeCache::put(const std::string& name, const QuadTree& tree)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    insert({name, tree, false, FileVersion()});
+}
+
+size_t
+TreeCache::get_size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+size_t
+TreeCache::get_hits() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+size_t
+TreeCache::get_misses() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+void
+TreeCache::insert(Entry entry)
+{
+    auto found = index_.find(entry.name);
+    if (found != index_.end()) {
+        entries_.erase(found->second);
+        index_.erase(found);
+    }
+
+    entries_.push_front(std::move(entry));
+    index_[entries_.front().name] = entries_.begin();
+
+    while (entries_.size() > capacity_) {
+        index_.erase(entries_.back().name);
+        entries_.pop_back();
+    }
+}
+
+bool
+TreeCache::stat_file(const std::string& path, FileVersion& version)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+        return false;
+    }
+
+    version.modified = info.st_mtim;
+    version.size = info.st_size;
+    return true;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <ctime>
+#include <sys/types.h>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "quad_tree.hpp"
+
+/** \brief A thread safe, least recently used cache of QuadTrees.
+ *
+ * Entries are keyed by name. A name is either the path of an image file, which is read on a miss
+ * via ImageReader, or the name of a tree stored with put(), eg. the result of a transform.
+ *
+ * Entries read from files remember the file's modification time and size, and are read again
+ * when either changes. Once the cache holds more than its capacity, the least recently used
+ * entries are evicted.
+ *
+ * Files are read outside of the cache's lock, so a slow load never blocks other clients. Trees are
+ * persistent, \sa QuadTree, so the snapshots handed out remain valid after their entry is evicted
+ * or replaced. */
+class TreeCache
+{
+public:
+    /** \brief Number of entries held when no capacity is passed to the constructor. */
+    static constexpr size_t DEFAULT_CAPACITY = 16;
+
+    /** \brief Creates an empty cache.
+     *
+     * \param capacity The maximum number of entries held. */
+    explicit TreeCache(size_t capacity = DEFAULT_CAPACITY);
+
+    /** \brief Retrieves a tree by name, reading it from a file on a miss.
+     *
+     * \param name The path of an image file, or the name passed to put().
+     * \param tree Set to the tree, if found.
+     * \return true iff the tree was cached, or read successfully. */
+    bool get(const std::string& name, QuadTree& tree);
+
+    /** \brief Stores a tree under a name, replacing any entry by that name.
+     *
+     * Stored trees are not backed by a file, and are never read again once evicted.
+     *
+     * \param name The name to store the tree under.
+     * \param tree The tree to store. */
+    void put(const std::string& name, const QuadTree& tree);
+
+    /** \brief Query the number of entries held. */
+    size_t get_size() const;
+
+    /** \brief Query the number of calls to get() served from the cache. */
+    size_t get_hits() const;
+
+    /** \brief Query the number of calls to get() which read a file. */
+    size_t get_misses() const;
+
+private:
+    /** \brief Identifies a version of a file, \sa stat(). */
+    struct FileVersion {
+        timespec modified; ///< Modification time
+        off_t size;        ///< Size, in bytes
+    };
+
+    /** \brief A cached tree. */
+    struct Entry {
+        std::string name;    ///< The entry's key
+        QuadTree tree;       ///< The cached tree
+        bool is_file;        ///< True iff the tree was read from a file
+        FileVersion version; ///< The version of the file the tree was read from
+    };
+
+    using Entries = std::list<Entry>;
+
+    size_t capacity_;  ///< Maximum number of entries
+    size_t hits_;      ///< Number of lookups served from the cache
+    size_t misses_;    ///< Number of lookups which read a file
+    Entries entries_;  ///< Entries, the most recently used first
+    std::unordered_map<std::string, Entries::iterator> index_; ///< Entries by name
+
+    mutable std::mutex mutex_; ///< Guards all of the above
+
+    /** \brief Inserts or replaces an entry, and evicts entries over capacity.
+     *
+     * Must be called with the lock held. */
+    void insert(Entry entry);
+
+    /** \brief Looks up the current version of a file.
+     *
+     * \param path The path of the file.
+     * \param version Set to the file's version, if it exists.
+     * \return true iff the file exists. */
+    static bool stat_file(const std::string& path, FileVersion& version);
+};
@@ -0,0 +1,155 @@
+#include "tree_server.hpp"
+
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+#include "image_reader.hpp"
+#include "image_writer.hpp"
+#include "tree_statistics.hpp"
+
+TreeServer::TreeServer(TreeCache& cache) :
+    cache_(cache)
+{ }
+
+std::string
+TreeServer::execute(const std::string& command)
+{
+    // a command which fails unexpectedly must not take down the session, or other clients
+    try {
+        return execute_command(command);
+    } catch (const std::exception& error) {
+        return std::string("error ") + error.what();
+    }
+}
+
+std::string
+TreeServer::execute_command(const std::string& command)
+{
+    std::istringstream line(command);
+    std::vector<std::string> words;
+    for (std::string word; line >> word;) {
+        words.push_back(word);
+    }
+
+    if (words.empty()) {
+        return "error empty command";
+    }
+
+    const auto& verb = words[0];
+    if (verb == "quit" && words.size() == 1) {
+        return "ok";
+    }
+
+    bool is_known =
+        (verb == "load"   && words.size() == 2) ||
+        (verb == "rotate" && words.size() == 4) ||
+        (verb == "scale"  && words.size() == 4) ||
+        (verb == "query"  && (words.size() == 2 || words.size() == 4)) ||
+        (verb == "write"  && words.size() == 3);
+    if (!is_known) {
+        return "error unknown command: " + command;
+    }
+
+    QuadTree tree;
+    if (!cache_.get(words[1], tree)) {
+        return "error unable to load: " + words[1];
+    }
+
+    if (verb == "load") {
+        return "ok " + std::to_string(tree.get_side_length());
+    }
+
+    if (verb == "rotate" || verb == "scale") {
+        double amount;
+        std::istringstream number(words[2]);
+        if (!(number >> amount) || !number.eof() || !std::isfinite(amount)) {
+            return "error invalid number: " + words[2];
+        }
+
+        // the scaled tree must be no larger than any which could be loaded
+        if (verb == "scale" && tree.get_side_length() * amount > ImageReader::MAX_SIDE_LENGTH) {
+            return "error scaled image too large: " + words[2];
+        }
+
+        QuadTree result;
+        if (verb == "scale") {
+            result = tree.scale(amount);
+        } else if (std::fmod(amount, 90) == 0) {
+            // quarter turns only permute nodes, so they are much cheaper than resampling
+            const QuadTree::Rotation rotations[] = {
+                QuadTree::Rotation::None,
+                QuadTree::Rotation::Clockwise90,
+                QuadTree::Rotation::Clockwise180,
+                QuadTree::Rotation::Clockwise270
+            };
+            // reduce to a single turn first, so the quotient fits however large the angle
+            auto quarter_turns = (long(std::fmod(amount, 360) / 90) + 4) % 4;
+            result = tree.rotate(rotations[quarter_turns]);
+        } else {
+            result = tree.rotate_by(amount);
+        }
+
+        if (!result.is_valid()) {
+            return "error unable to " + verb + " by " + words[2];
+        }
+
+        cache_.put(words[3], result);
+        return "ok " + std::to_string(result.get_side_length());
+    }
+
+    if (verb == "query" && words.size() == 2) {
+        return "ok " + std::to_string(tree.get_side_length()) + " " +
+            std::to_string(TreeStatistics::count_black_pixels(tree));
+    }
+
+    if (verb == "query") {
+        size_t x;
+        size_t y;
+        std::istringstream coordinates(words[2] + " " + words[3]);
+        if (!(coordinates >> x >> y)) {
+            return "error invalid coordinates";
+        }
+
+        switch (tree.get_pixel(x, y)) {
+        case QuadNode::ColorValue::Black: return "ok black";
+        case QuadNode::ColorValue::White: return "ok white";
+        case QuadNode::ColorValue::Mixed: break;
+        }
+        return "error out of bounds";
+    }
+
+    // write
+    ImageWriter::Format format;
+    if (!ImageWriter::format_from_file_name(words[2], format)) {
+        return "error unsupported output format: " + words[2];
+    }
+    if (!ImageWriter(format).write(tree, words[2])) {
+        return "error unable to write: " + words[2];
+    }
+    return "ok";
+}
+
+void
+TreeServer::serve(std::istream& in, std::ostream& out)
+{
+    for (std::string command; std::getline(in, command);) {
+        if (command.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+
+        out << execute(command) << std::endl;
+        if (is_quit(command)) {
+            return;
+        }
+    }
+}
+
+bool
+TreeServer::is_quit(const std::string& command)
+{
+    std::istringstream line(command);
+    std::string verb;
+    std::string extra;
+    return (line >> verb) && verb == "quit" && !(line >> extra);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include "tree_cache.hpp"
+
+/** \brief Executes editing commands against trees kept resident in a TreeCache.
+ *
+ * Commands are single lines of whitespace separated words, each answered by a single line which
+ * starts with either "ok" or "error". Trees are named by the path of their image file, or by the
+ * name a previous command stored its result under:
+ *
+ * \verbatim
+ * load <path>                       ok <side_length>
+ * rotate <name> <degrees> <result>  ok <side_length>
+ * scale <name> <factor> <result>    ok <side_length>
+ * query <name>                      ok <side_length> <black_pixels>
+ * query <name> <x> <y>              ok black|white
+ * write <name> <path>               ok
+ * quit                              ok, and ends the session, \sa serve()
+ * \endverbatim
+ *
+ * execute() only touches the cache, which is thread safe, and persistent trees, so one server can
+ * serve many clients concurrently. A command which fails, whether through bad arguments or by
+ * running out of memory, is answered with an error and leaves the server running. Images and
+ * scaled trees are limited to ImageReader::MAX_SIDE_LENGTH. */
+class TreeServer
+{
+public:
+    /** \brief Creates a server for the trees in a cache.
+     *
+     * \param cache The cache to serve trees from, which must outlive the server. */
+    explicit TreeServer(TreeCache& cache);
+
+    /** \brief Executes a single command.
+     *
+     * \param command The command line, without its line ending.
+     * \return The response line, without a line ending. Exceptions are answered as errors. */
+    std::string execute(const std::string& command);
+
+    /** \brief Executes commands read from a stream, one per line, until it ends or a quit command.
+     *
+     * Blank lines are ignored. Each response is written as a line, and flushed.
+     *
+     * \param in The stream to read commands from.
+     * \param out The stream to write responses to. */
+    void serve(std::istream& in, std::ostream& out);
+
+    /** \brief Query whether a command ends the session.
+     *
+     * \param command The command line.
+     * \return true iff the command is quit. */
+    static bool is_quit(const std::string& command);
+
+private:
+    TreeCache& cache_; ///< Source of the trees commands act on
+
+    /** \brief Executes a single command, which may throw, \sa execute(). */
+    std::string execute_command(const std::string& command);
+};
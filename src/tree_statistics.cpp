@@ -0,0 +1,326 @@
+#include "tree_statistics.hpp"
+
+#include <algorithm>
+#include <bitset>
+
+using ColorValue = QuadNode::ColorValue;
+
+size_t
+TreeStatistics::count_black_pixels(const QuadTree& tree)
+{
+    return tree.is_valid() ? tree.get_root()->get_black_pixels() : 0;
+}
+
+bool
+TreeStatistics::get_black_bounds(const QuadTree& tree, QuadTree::Rect& bounds)
+{
+    return tree.get_content_bounds(bounds);
+}
+
+std::vector<TreeStatistics::Component>
+TreeStatistics::find_components(const QuadTree& tree, Connectivity connectivity)
+{
+    if (!tree.is_valid()) {
+        return { };
+    }
+
+    Labeling labeling;
+    labeling.side_length = tree.get_side_length();
+    labeling.gap = (connectivity == Connectivity::Eight) ? 1 : 0;
+
+    auto root = tree.get_root();
+    label_elements(labeling, *root, 0, 0);
+    connect_siblings(labeling, *root, 0, 0);
+
+    // gather each set of elements into a component, keyed by its representative
+    std::unordered_map<size_t, size_t> component_ndx;
+    std::vector<Component> components;
+    for (size_t id = 0; id < labeling.elements.size(); ++id) {
+        auto representative = find(labeling, id);
+        auto found = component_ndx.find(representative);
+        if (found == component_ndx.end()) {
+            component_ndx[representative] = components.size();
+            components.push_back(labeling.elements[id]);
+        } else {
+            merge(components[found->second], labeling.elements[id]);
+        }
+    }
+
+    std::sort(components.begin(), components.end(), [](const Component& one, const Component& other) {
+        return one.bounds.y != other.bounds.y ? one.bounds.y < other.bounds.y
+                                              : one.bounds.x < other.bounds.x;
+    });
+
+    return components;
+}
+
+size_t
+TreeStatistics::add_element(Labeling& labeling, size_t x, size_t y, size_t side_length)
+{
+    auto id = labeling.elements.size();
+    labeling.ids[uint64_t(y) * labeling.side_length + x] = id;
+    labeling.parents.push_back(id);
+    labeling.elements.push_back({side_length * side_length, {x, y, side_length, side_length}});
+    return id;
+}
+
+size_t
+TreeStatistics::find(Labeling& labeling, size_t id)
+{
+    // path halving keeps the trees shallow without recursion
+    while (labeling.parents[id] != id) {
+        labeling.parents[id] = labeling.parents[labeling.parents[id]];
+        id = labeling.parents[id];
+    }
+    return id;
+}
+
+void
+TreeStatistics::unite(Labeling& labeling, size_t one, size_t other)
+{
+    one = find(labeling, one);
+    other = find(labeling, other);
+    if (one != other) {
+        labeling.parents[std::max(one, other)] = std::min(one, other);
+    }
+}
+
+void
+TreeStatistics::label_elements(Labeling& labeling, const QuadNode& node, size_t x_off, size_t y_off)
+{
+    auto side_length = node.get_side_length();
+
+    if (node.is_block()) {
+        // each black pixel of a block is an element, connected to its black neighbors in the block
+        std::bitset<64> block(node.get_block());
+        std::vector<size_t> pixel_ids(64);
+        for (size_t y = 0; y < side_length; ++y) {
+            for (size_t x = 0; x < side_length; ++x) {
+                if (block[y * side_length + x]) {
+                    pixel_ids[y * side_length + x] = add_element(labeling, x_off + x, y_off + y, 1);
+                }
+            }
+        }
+
+        for (size_t y = 0; y < side_length; ++y) {
+            for (size_t x = 0; x < side_length; ++x) {
+                auto ndx = y * side_length + x;
+                if (!block[ndx]) {
+                    continue;
+                }
+
+                if (x + 1 < side_length && block[ndx + 1]) {
+                    unite(labeling, pixel_ids[ndx], pixel_ids[ndx + 1]);
+                }
+                if (y + 1 < side_length && block[ndx + side_length]) {
+                    unite(labeling, pixel_ids[ndx], pixel_ids[ndx + side_length]);
+                }
+                if (labeling.gap && y + 1 < side_length) {
+                    if (x + 1 < side_length && block[ndx + side_length + 1]) {
+                        unite(labeling, pixel_ids[ndx], pixel_ids[ndx + side_length + 1]);
+                    }
+                    if (x > 0 && block[ndx + side_length - 1]) {
+                        unite(labeling, pixel_ids[ndx], pixel_ids[ndx + side_length - 1]);
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    if (node.is_leaf()) {
+        if (node.get_color_value() == ColorValue::Black) {
+            add_element(labeling, x_off, y_off, side_length);
+        }
+        return;
+    }
+
+    auto half = side_length / 2;
+    const auto& children = node.get_children();
+
+    label_elements(labeling, *children.q1, x_off + half, y_off       );
+    label_elements(labeling, *children.q2, x_off       , y_off       );
+    label_elements(labeling, *children.q3, x_off       , y_off + half);
+    label_elements(labeling, *children.q4, x_off + half, y_off + half);
+}
+
+void
+TreeStatistics::connect_siblings(Labeling& labeling, const QuadNode& node, size_t x_off, size_t y_off)
+{
+    if (node.is_leaf()) {
+        return;
+    }
+
+    auto half = node.get_side_length() / 2;
+    const auto& children = node.get_children();
+
+    connect_siblings(labeling, *children.q1, x_off + half, y_off       );
+    connect_siblings(labeling, *children.q2, x_off       , y_off       );
+    connect_siblings(labeling, *children.q3, x_off       , y_off + half);
+    connect_siblings(labeling, *children.q4, x_off + half, y_off + half);
+
+    std::vector<Interval> one;
+    std::vector<Interval> other;
+    auto connect = [&](const QuadNode& first, size_t first_x, size_t first_y, Edge first_edge,
+                       const QuadNode& second, size_t second_x, size_t second_y, Edge second_edge) {
+        one.clear();
+        other.clear();
+        collect_edge(labeling, first, first_x, first_y, first_edge, one);
+        collect_edge(labeling, second, second_x, second_y, second_edge, other);
+        connect_intervals(labeling, one, other);
+    };
+
+    // NW|NE and SW|SE share vertical edges, NW/SW and NE/SE horizontal ones
+    connect(*children.q2, x_off, y_off, Edge::Right,
+            *children.q1, x_off + half, y_off, Edge::Left);
+    connect(*children.q3, x_off, y_off + half, Edge::Right,
+            *children.q4, x_off + half, y_off + half, Edge::Left);
+    connect(*children.q2, x_off, y_off, Edge::Bottom,
+            *children.q3, x_off, y_off + half, Edge::Top);
+    connect(*children.q1, x_off + half, y_off, Edge::Bottom,
+            *children.q4, x_off + half, y_off + half, Edge::Top);
+
+    if (!labeling.gap) {
+        return;
+    }
+
+    // NW and SE, and NE and SW, only share a corner at the center of the node
+    size_t one_id;
+    size_t other_id;
+    auto center_x = x_off + half;
+    auto center_y = y_off + half;
+    if (find_element(labeling, node, x_off, y_off, center_x - 1, center_y - 1, one_id) &&
+        find_element(labeling, node, x_off, y_off, center_x, center_y, other_id)) {
+        unite(labeling, one_id, other_id);
+    }
+    if (find_element(labeling, node, x_off, y_off, center_x, center_y - 1, one_id) &&
+        find_element(labeling, node, x_off, y_off, center_x - 1, center_y, other_id)) {
+        unite(labeling, one_id, other_id);
+    }
+}
+
+void
+TreeStatistics::collect_edge(Labeling& labeling, const QuadNode& node, size_t x_off, size_t y_off,
+                             Edge edge, std::vector<Interval>& intervals)
+{
+    auto side_length = node.get_side_length();
+    bool is_vertical = (edge == Edge::Left || edge == Edge::Right);
+
+    if (node.is_block()) {
+        auto block = node.get_block();
+        for (size_t ndx = 0; ndx < side_length; ++ndx) {
+            size_t x = is_vertical ? (edge == Edge::Left ? 0 : side_length - 1) : ndx;
+            size_t y = is_vertical ? ndx : (edge == Edge::Top ? 0 : side_length - 1);
+
+            if ((block >> (y * side_length + x)) & 1) {
+                auto id = labeling.ids[uint64_t(y_off + y) * labeling.side_length + x_off + x];
+                auto begin = is_vertical ? y_off + y : x_off + x;
+                intervals.push_back({begin, begin + 1, id});
+            }
+        }
+        return;
+    }
+
+    if (node.is_leaf()) {
+        if (node.get_color_value() == ColorValue::Black) {
+            auto id = labeling.ids[uint64_t(y_off) * labeling.side_length + x_off];
+            auto begin = is_vertical ? y_off : x_off;
+            intervals.push_back({begin, begin + side_length, id});
+        }
+        return;
+    }
+
+    auto half = side_length / 2;
+    const auto& children = node.get_children();
+
+    // visit the two children along the edge, in order
+    switch (edge) {
+    case Edge::Left:
+        collect_edge(labeling, *children.q2, x_off, y_off, edge, intervals);
+        collect_edge(labeling, *children.q3, x_off, y_off + half, edge, intervals);
+        break;
+    case Edge::Right:
+        collect_edge(labeling, *children.q1, x_off + half, y_off, edge, intervals);
+        collect_edge(labeling, *children.q4, x_off + half, y_off + half, edge, intervals);
+        break;
+    case Edge::Top:
+        collect_edge(labeling, *children.q2, x_off, y_off, edge, intervals);
+        collect_edge(labeling, *children.q1, x_off + half, y_off, edge, intervals);
+        break;
+    case Edge::Bottom:
+        collect_edge(labeling, *children.q3, x_off, y_off + half, edge, intervals);
+        collect_edge(labeling, *children.q4, x_off + half, y_off + half, edge, intervals);
+        break;
+    }
+}
+
+void
+TreeStatistics::connect_intervals(
+        Labeling& labeling, const std::vector<Interval>& one, const std::vector<Interval>& other)
+{
+    // both lists are sorted and disjoint, with 8-connectivity runs touching at a corner connect
+    size_t first = 0;
+    for (const auto& interval : one) {
+        while (first < other.size() && other[first].end + labeling.gap <= interval.begin) {
+            ++first;
+        }
+
+        for (auto ndx = first;
+             ndx < other.size() && other[ndx].begin < interval.end + labeling.gap; ++ndx) {
+            unite(labeling, interval.id, other[ndx].id);
+        }
+    }
+}
+
+bool
+TreeStatistics::find_element(Labeling& labeling, const QuadNode& node, size_t x_off, size_t y_off,
+                             size_t x, size_t y, size_t& id)
+{
+    const QuadNode* current = &node;
+
+    while (!current->is_leaf()) {
+        auto half = current->get_side_length() / 2;
+        const auto& children = current->get_children();
+        bool is_right = x >= x_off + half;
+        bool is_bottom = y >= y_off + half;
+
+        const auto& child = is_bottom ? (is_right ? children.q4 : children.q3)
+                                      : (is_right ? children.q1 : children.q2);
+        x_off += is_right ? half : 0;
+        y_off += is_bottom ? half : 0;
+        current = child.get();
+    }
+
+    if (current->is_block()) {
+        auto bit = (y - y_off) * current->get_side_length() + (x - x_off);
+        if (!((current->get_block() >> bit) & 1)) {
+            return false;
+        }
+        id = labeling.ids[uint64_t(y) * labeling.side_length + x];
+        return true;
+    }
+
+    if (current->get_color_value() != ColorValue::Black) {
+        return false;
+    }
+
+    id = labeling.ids[uint64_t(y_off) * labeling.side_length + x_off];
+    return true;
+}
+
+void
+TreeStatistics::merge(Component& into, const Component& from)
+{
+    if (into.black_pixels == 0) {
+        into = from;
+        return;
+    }
+
+    auto left = std::min(into.bounds.x, from.bounds.x);
+    auto top = std::min(into.bounds.y, from.bounds.y);
+    auto right = std::max(into.bounds.x + into.bounds.width, from.bounds.x + from.bounds.width);
+    auto bottom = std::max(into.bounds.y + into.bounds.height, from.bounds.y + from.bounds.height);
+
+    into.black_pixels += from.black_pixels;
+    into.bounds = {left, top, right - left, bottom - top};
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "quad_tree.hpp"
+
+/** \brief Area statistics and connected components of the black pixels of a QuadTree.
+ *
+ * Area and bounds are read from the aggregates cached by the root node in O(1), \sa
+ * QuadNode::get_black_pixels(). Components are computed from the leaves of the tree rather than
+ * from its pixels. A homogenous leaf contributes its whole area at once, and only the pixels of
+ * block nodes are looked at individually, so their cost is proportional to the number of leaves.
+ *
+ * Connected components are found with union-find. Each black leaf (or black pixel of a block) is
+ * an element, and elements are joined by matching the boundaries of each pair of adjacent
+ * siblings in the tree, which only visits the leaves along those boundaries. */
+class TreeStatistics
+{
+public:
+    /** \brief Which neighbors of a pixel it is connected to. */
+    enum class Connectivity {
+        Four, ///< Pixels sharing an edge
+        Eight ///< Pixels sharing an edge or a corner
+    };
+
+    /** \brief A connected set of black pixels. */
+    struct Component {
+        size_t black_pixels;   ///< Number of pixels in the component
+        QuadTree::Rect bounds; ///< Bounding box of the component
+    };
+
+    /** \brief Counts the black pixels of an image.
+     *
+     * \param tree The tree encoding the image.
+     * \return The number of black pixels, or 0 if the tree is invalid. */
+    static size_t count_black_pixels(const QuadTree& tree);
+
+    /** \brief Finds the bounding box of the black pixels of an image.
+     *
+     * \param tree The tree encoding the image.
+     * \param bounds Set to the bounding box, if there are any black pixels.
+     * \return true iff the tree is valid and has at least one black pixel. */
+    static bool get_black_bounds(const QuadTree& tree, QuadTree::Rect& bounds);
+
+    /** \brief Finds the connected components of the black pixels of an image.
+     *
+     * \param tree The tree encoding the image.
+     * \param connectivity Which neighboring pixels are considered connected.
+     * \return The components, ordered by the top, then left, edges of their bounds, or no
+     *         components if the tree is invalid. */
+    static std::vector<Component> find_components(
+            const QuadTree& tree, Connectivity connectivity = Connectivity::Eight);
+
+private:
+    /** \brief A run of black pixels along the edge of a subtree, belonging to one element. */
+    struct Interval {
+        size_t begin;  ///< First pixel of the run, along the edge
+        size_t end;    ///< One past the last pixel of the run, along the edge
+        size_t id;     ///< The element the run belongs to
+    };
+
+    /** \brief The edges of a quadrant. */
+    enum class Edge {
+        Left,
+        Right,
+        Top,
+        Bottom
+    };
+
+    /** \brief State of a connected component labeling pass. */
+    struct Labeling {
+        size_t side_length;                         ///< Side length of the image
+        size_t gap;                                 ///< 1 for 8-connectivity, 0 for 4
+        std::unordered_map<uint64_t, size_t> ids;   ///< Element id by top-left pixel index
+        std::vector<size_t> parents;                ///< Union-find forest over element ids
+        std::vector<Component> elements;            ///< Area and bounds of each element
+    };
+
+    /** \brief Adds a black element to the labeling.
+     *
+     * \return The id of the new element. */
+    static size_t add_element(Labeling& labeling, size_t x, size_t y, size_t side_length);
+
+    /** \brief Finds the representative element of an element's set. */
+    static size_t find(Labeling& labeling, size_t id);
+
+    /** \brief Merges the sets of two elements. */
+    static void unite(Labeling& labeling, size_t one, size_t other);
+
+    /** \brief Assigns ids to the black elements of a subtree, and connects the pixels of blocks.
+     *
+     * \param node The root of the subtree.
+     * \param x_off x offset of the subtree's quadrant within the image
+     * \param y_off y offset of the subtree's quadrant within the image */
+    static void label_elements(Labeling& labeling, const QuadNode& node, size_t x_off, size_t y_off);
+
+    /** \brief Connects the elements on either side of the boundaries between siblings.
+     *
+     * \param node The root of the subtree.
+     * \param x_off x offset of the subtree's quadrant within the image
+     * \param y_off y offset of the subtree's quadrant within the image */
+    static void connect_siblings(
+            Labeling& labeling, const QuadNode& node, size_t x_off, size_t y_off);
+
+    /** \brief Collects the runs of black pixels along one edge of a subtree, in order.
+     *
+     * \param node The root of the subtree.
+     * \param x_off x offset of the subtree's quadrant within the image
+     * \param y_off y offset of the subtree's quadrant within the image
+     * \param edge The edge to collect.
+     * \param intervals The collected runs, appended in order along the edge. */
+    static void collect_edge(Labeling& labeling, const QuadNode& node, size_t x_off, size_t y_off,
+                             Edge edge, std::vector<Interval>& intervals);
+
+    /** \brief Connects the runs of two facing edges which touch.
+     *
+     * \param one The runs along one edge.
+     * \param other The runs along the facing edge. */
+    static void connect_intervals(
+            Labeling& labeling, const std::vector<Interval>& one, const std::vector<Interval>& other);
+
+    /** \brief Finds the element covering a pixel.
+     *
+     * \param node The root of the subtree containing the pixel.
+     * \param x_off x offset of the subtree's quadrant within the image
+     * \param y_off y offset of the subtree's quadrant within the image
+     * \param x The pixel's column.
+     * \param y The pixel's row.
+     * \param id Set to the id of the element, if the pixel is black.
+     * \return true iff the pixel is black. */
+    static bool find_element(Labeling& labeling, const QuadNode& node, size_t x_off, size_t y_off,
+                             size_t x, size_t y, size_t& id);
+
+    /** \brief Grows a component's bounds and area to include another's. */
+    static void merge(Component& into, const Component& from);
+};